@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2024-2025 Emilien Kia <emilien.kia+dev@gmail.com>
+ *
+ * sqlcpp is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlcpp is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.";
+ */
+#include "catch.hpp"
+
+#include "bench.hpp"
+
+#include "sqlcpp/sqlite.hpp"
+#include "sqlcpp/postgresql.hpp"
+#include "sqlcpp/mariadb.hpp"
+
+#include <cstdlib>
+#include <tuple>
+#include <vector>
+
+static const size_t row_count = 1000;
+
+// Row values, shared by the table fill and the bulk insert benchmarks
+struct bench_rows {
+    std::vector<int64_t> ids;
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<std::string> texts;
+    std::vector<sqlcpp::blob> blobs;
+
+    bench_rows() : ids(row_count), ints(row_count), doubles(row_count), texts(row_count), blobs(row_count) {
+        for (size_t i = 0; i < row_count; ++i) {
+            ids[i] = i + 1;
+            ints[i] = i * 7;
+            doubles[i] = i * 0.5;
+            texts[i] = "text value " + std::to_string(i);
+            blobs[i] = sqlcpp::blob(64, static_cast<unsigned char>(i));
+        }
+    }
+
+    void bind(sqlcpp::statement& stmt, unsigned int first_index) const {
+        stmt.bind_array(first_index, sqlcpp::span<const int64_t>(ids));
+        stmt.bind_array(first_index + 1, sqlcpp::span<const int64_t>(ints));
+        stmt.bind_array(first_index + 2, sqlcpp::span<const double>(doubles));
+        stmt.bind_array(first_index + 3, sqlcpp::span<const std::string>(texts));
+        stmt.bind_array(first_index + 4, sqlcpp::span<const sqlcpp::blob>(blobs));
+    }
+};
+
+void run_driver_benchmarks(const bench_target& target)
+{
+    sqlcpp::connection& db = *target.db;
+    const unsigned int first = target.first_index;
+    const bench_rows rows;
+
+    db.execute("DROP TABLE IF EXISTS bench");
+    db.execute("DROP TABLE IF EXISTS bench_insert");
+    db.execute("CREATE TABLE bench (id BIGINT PRIMARY KEY, i BIGINT, d DOUBLE PRECISION, t VARCHAR(64), b " + target.blob_type + ")");
+    db.execute("CREATE TABLE bench_insert (id BIGINT, i BIGINT, d DOUBLE PRECISION, t VARCHAR(64), b " + target.blob_type + ")");
+
+    auto fill = db.prepare("INSERT INTO bench(id, i, d, t, b) VALUES(" + target.placeholders(5) + ")");
+    REQUIRE( !!fill );
+    rows.bind(*fill, first);
+    REQUIRE( !!fill->execute_array() );
+
+    const std::string select_query = "SELECT id, i, d, t, b FROM bench ORDER BY id";
+    auto select = db.prepare(select_query);
+    REQUIRE( !!select );
+    auto point = db.prepare("SELECT t FROM bench WHERE id = " + target.placeholders(1));
+    REQUIRE( !!point );
+    auto by_text = db.prepare("SELECT id FROM bench WHERE t = " + target.placeholders(1));
+    REQUIRE( !!by_text );
+
+    //
+    // Statement preparation and binding
+    //
+
+    BENCHMARK("prepare") {
+        return db.prepare(select_query);
+    };
+
+    BENCHMARK("prepare_cached") {
+        return db.prepare_cached(select_query);
+    };
+
+    BENCHMARK("bind int64") {
+        return &point->bind(first, (int64_t) 42);
+    };
+
+    const std::string text = rows.texts[42];
+    BENCHMARK("bind string") {
+        return &by_text->bind(first, text);
+    };
+
+    BENCHMARK("bind_ref string") {
+        return &by_text->bind_ref(first, std::string_view(text));
+    };
+
+    BENCHMARK("point query") {
+        point->bind(first, (int64_t) 500);
+        return point->execute_buffered()->row_count();
+    };
+
+    //
+    // Executions, reading all the columns of 1000 rows
+    //
+
+    BENCHMARK("execute, iteration only") {
+        size_t count = 0;
+        auto rset = select->execute();
+        for (const sqlcpp::row& row : *rset) {
+            count += row.ok();
+        }
+        return count;
+    };
+
+    BENCHMARK("execute, typed getters") {
+        size_t size = 0;
+        auto rset = select->execute();
+        for (const sqlcpp::row& row : *rset) {
+            size += row.get_value_int64(0) + row.get_value_int64(1) + (int64_t) row.get_value_double(2);
+            size += row.get_value_string_view(3).size() + row.get_value_blob_span(4).size();
+        }
+        return size;
+    };
+
+    BENCHMARK("execute, values") {
+        size_t count = 0;
+        auto rset = select->execute();
+        for (const sqlcpp::row& row : *rset) {
+            count += row.get_values().size();
+        }
+        return count;
+    };
+
+    BENCHMARK("execute(func)") {
+        size_t size = 0;
+        select->execute([&](const sqlcpp::row_base& row) {
+            size += row.get_value_int64(0) + row.get_value_int64(1) + (int64_t) row.get_value_double(2);
+            size += row.get_value_string_view(3).size() + row.get_value_blob_span(4).size();
+        });
+        return size;
+    };
+
+    BENCHMARK("execute_buffered") {
+        size_t size = 0;
+        auto rset = select->execute_buffered();
+        for (unsigned int i = 0; i < rset->row_count(); ++i) {
+            const sqlcpp::row_base& row = rset->get_row(i);
+            size += row.get_value_int64(0) + row.get_value_int64(1) + (int64_t) row.get_value_double(2);
+            size += row.get_value_string_view(3).size() + row.get_value_blob_span(4).size();
+        }
+        return size;
+    };
+
+    BENCHMARK("execute_columnar") {
+        auto rset = select->execute_columnar();
+        int64_t sum = 0;
+        for (int64_t value : rset->int64_values(1)) {
+            sum += value;
+        }
+        return sum;
+    };
+
+    BENCHMARK("execute_as") {
+        return select->execute_as<std::tuple<int64_t, int64_t, double, std::string, sqlcpp::blob>>()->size();
+    };
+
+    BENCHMARK("fetch_batch") {
+        std::vector<int64_t> ints(256);
+        std::vector<double> doubles(256);
+        std::vector<sqlcpp::batch_column> columns = {
+            {1, sqlcpp::span<int64_t>(ints)},
+            {2, sqlcpp::span<double>(doubles)},
+        };
+        size_t total = 0;
+        auto rset = select->execute();
+        while (size_t count = rset->fetch_batch(columns)) {
+            total += count;
+        }
+        return total;
+    };
+
+    //
+    // Bulk inserts of 1000 rows
+    //
+
+    auto insert = db.prepare("INSERT INTO bench_insert(id, i, d, t, b) VALUES(" + target.placeholders(5) + ")");
+    REQUIRE( !!insert );
+
+    BENCHMARK_ADVANCED("bulk insert, row by row")(Catch::Benchmark::Chronometer meter) {
+        db.execute("DELETE FROM bench_insert");
+        meter.measure([&] {
+            db.execute("BEGIN");
+            for (size_t i = 0; i < row_count; ++i) {
+                insert->bind(first, rows.ids[i]);
+                insert->bind(first + 1, rows.ints[i]);
+                insert->bind(first + 2, rows.doubles[i]);
+                insert->bind(first + 3, rows.texts[i]);
+                insert->bind(first + 4, rows.blobs[i]);
+                insert->execute();
+            }
+            db.execute("COMMIT");
+        });
+    };
+
+    BENCHMARK_ADVANCED("bulk insert, execute_array")(Catch::Benchmark::Chronometer meter) {
+        db.execute("DELETE FROM bench_insert");
+        rows.bind(*insert, first);
+        meter.measure([&] {
+            return insert->execute_array();
+        });
+        insert->reset();
+    };
+
+    db.execute("DROP TABLE bench_insert");
+    db.execute("DROP TABLE bench");
+}
+
+
+TEST_CASE("SQLite benchmarks", "[benchmark][sqlite]") {
+    bench_target target;
+    target.db = sqlcpp::sqlite::connection::create(":memory:");
+    REQUIRE( !!target.db );
+    run_driver_benchmarks(target);
+}
+
+TEST_CASE("PostgreSQL benchmarks", "[benchmark][postgresql]") {
+    const char* connection_string = std::getenv("SQLCPP_BENCH_POSTGRESQL");
+    if (!connection_string) {
+        WARN( "SQLCPP_BENCH_POSTGRESQL not set, PostgreSQL benchmarks skipped" );
+        return;
+    }
+    bench_target target;
+    target.db = sqlcpp::postgresql::connection::create(connection_string);
+    REQUIRE( !!target.db );
+    target.first_index = 1;
+    target.numbered_placeholders = true;
+    target.blob_type = "BYTEA";
+    run_driver_benchmarks(target);
+}
+
+TEST_CASE("MariaDB benchmarks", "[benchmark][mariadb]") {
+    const char* connection_string = std::getenv("SQLCPP_BENCH_MARIADB");
+    if (!connection_string) {
+        WARN( "SQLCPP_BENCH_MARIADB not set, MariaDB benchmarks skipped" );
+        return;
+    }
+    bench_target target;
+    target.db = sqlcpp::mariadb::connection::create(connection_string);
+    REQUIRE( !!target.db );
+    target.first_index = 1;
+    run_driver_benchmarks(target);
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2024-2025 Emilien Kia <emilien.kia+dev@gmail.com>
+ *
+ * sqlcpp is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlcpp is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.";
+ */
+#include "catch.hpp"
+
+#include "sqlcpp/sqlcpp.hpp"
+#include "sqlcpp/details.hpp"
+
+TEST_CASE("Value conversions", "[benchmark][values]") {
+    const sqlcpp::value int_value = (int64_t) 1234567890123;
+    const sqlcpp::value double_value = 3.14159265358979;
+    const sqlcpp::value string_value = std::string("1234567890123");
+    const sqlcpp::value double_string_value = std::string("3.14159265358979");
+    const sqlcpp::value blob_value = sqlcpp::blob(64, 0xA5);
+
+    BENCHMARK("to_string(int64)") {
+        return sqlcpp::to_string(int_value);
+    };
+
+    BENCHMARK("to_string(double)") {
+        return sqlcpp::to_string(double_value);
+    };
+
+    BENCHMARK("to_string(blob)") {
+        return sqlcpp::to_string(blob_value);
+    };
+
+    BENCHMARK("to_int64(int64)") {
+        return sqlcpp::to_int64(int_value);
+    };
+
+    BENCHMARK("to_int64(string)") {
+        return sqlcpp::to_int64(string_value);
+    };
+
+    BENCHMARK("to_double(string)") {
+        return sqlcpp::to_double(double_string_value);
+    };
+
+    BENCHMARK("to_blob(string)") {
+        return sqlcpp::to_blob(string_value);
+    };
+
+    BENCHMARK("to_string_view(string)") {
+        return sqlcpp::to_string_view(string_value);
+    };
+
+    BENCHMARK("value copy(blob)") {
+        return sqlcpp::value(blob_value);
+    };
+}
+
+TEST_CASE("Hex codecs", "[benchmark][hex]") {
+    const sqlcpp::blob data(4096, 0x5A);
+    const std::string hex = sqlcpp::details::blob_to_hex_string(data);
+    sqlcpp::blob decoded(data.size());
+
+    BENCHMARK("hex encode 4KB") {
+        return sqlcpp::details::blob_to_hex_string(data);
+    };
+
+    BENCHMARK("hex decode 4KB") {
+        return sqlcpp::details::hex_decode(hex, decoded.data());
+    };
+}
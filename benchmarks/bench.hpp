@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2024-2025 Emilien Kia <emilien.kia+dev@gmail.com>
+ *
+ * sqlcpp is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlcpp is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.";
+ */
+
+#ifndef SQLCPP_BENCH_HPP
+#define SQLCPP_BENCH_HPP
+
+#include "sqlcpp/sqlcpp.hpp"
+
+#include <memory>
+#include <string>
+
+// Connection to benchmark and its SQL dialect
+struct bench_target {
+    std::shared_ptr<sqlcpp::connection> db;
+    // Index of the first statement parameter
+    unsigned int first_index = 0;
+    // Numbered ($1, $2...) or anonymous (?) placeholders
+    bool numbered_placeholders = false;
+    std::string blob_type = "BLOB";
+
+    // Comma separated placeholders for count parameters
+    std::string placeholders(unsigned int count) const {
+        std::string res;
+        for (unsigned int i = 1; i <= count; ++i) {
+            if (i > 1) {
+                res += ", ";
+            }
+            res += numbered_placeholders ? "$" + std::to_string(i) : "?";
+        }
+        return res;
+    }
+};
+
+// Run the statement, execution and bulk insert benchmarks on a target
+void run_driver_benchmarks(const bench_target& target);
+
+#endif //SQLCPP_BENCH_HPP
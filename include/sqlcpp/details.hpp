@@ -20,6 +20,7 @@
 
 #include <filesystem>
 #include <map>
+#include <memory_resource>
 
 #include "sqlcpp.hpp"
 
@@ -27,6 +28,58 @@ namespace sqlcpp::details {
 
 std::string blob_to_hex_string(const blob& data) ;
 
+// Hex codecs, vectorized when supported by the CPU.
+// Encoding writes data.size()*2 lowercase digits to out.
+void hex_encode(blob_span data, char* out);
+// Decoding writes hex.size()/2 bytes to out, false for odd sizes and non hex digits.
+bool hex_decode(std::string_view hex, unsigned char* out);
+
+// PostgreSQL bytea escape format decoder, false for invalid escape sequences.
+bool bytea_unescape(std::string_view str, blob& out);
+
+
+// Sizes of the non-NULL values of a row, as reported to connection_observer::on_fetch()
+size_t row_bytes(const row_base& row);
+
+// Timings and counters of a prepare or an execution, reported to a connection_observer.
+// Only created when an observer is set, see connection::observe() and statement::observe().
+class query_observation
+{
+protected:
+    typedef std::chrono::steady_clock clock;
+
+    std::shared_ptr<connection_observer> _observer;
+    std::string _query;
+    clock::time_point _start;
+    clock::time_point _executed;
+    bool _fetching = false;
+    unsigned long long _rows = 0;
+    unsigned long long _bytes = 0;
+
+public:
+    query_observation(std::shared_ptr<connection_observer> observer, std::string query);
+    query_observation(const query_observation&) = delete;
+    query_observation& operator=(const query_observation&) = delete;
+    // Report the fetch, if results were expected
+    ~query_observation();
+
+    // Report the prepare, and attach the observer to the prepared statement
+    void prepared(statement& stmt, bool cache_hit = false);
+    // Report the execution, results are then expected to be fetched
+    void executed(bool results = true);
+
+    void fetched(const row_base& row) {
+        ++_rows;
+        _bytes += row_bytes(row);
+    }
+    void fetched(unsigned long long rows, unsigned long long bytes) {
+        _rows += rows;
+        _bytes += bytes;
+    }
+    // All the rows of a buffered execution
+    void fetched(const buffered_resultset& rset);
+};
+
 
 class simple_stats_result : public stats_result
 {
@@ -67,6 +120,8 @@ public:
         return _values;
     }
 
+    const std::vector<value>& values() const { return _values; }
+
     void add_value(const value& value) { _values.push_back(value); }
     void add_value(value&& value) { _values.push_back(std::move(value)); }
 
@@ -83,12 +138,49 @@ public:
     int get_value_int(unsigned index) const override;
     int64_t get_value_int64(unsigned index) const override;
     double get_value_double(unsigned index) const override;
+    std::string_view get_value_string_view(unsigned index) const override;
+    blob_span get_value_blob_span(unsigned index) const override;
+    bool is_null(unsigned index) const override;
 };
 
 
+class generic_buffered_resultset;
+
+// Row view over a generic_buffered_resultset row
+class buffered_row : public row_base
+{
+protected:
+    const generic_buffered_resultset* _resultset = nullptr;
+    size_t _first = 0;
+    size_t _size = 0;
+
+public:
+    buffered_row() = default;
+    buffered_row(const generic_buffered_resultset* resultset, size_t first, size_t size) : _resultset(resultset), _first(first), _size(size) {}
+    ~buffered_row() override = default;
+
+    size_t size() const override { return _size; }
+
+    value get_value(unsigned index) const override;
+
+    std::string get_value_string(unsigned index) const override;
+    blob get_value_blob(unsigned index) const override;
+    bool get_value_bool(unsigned index) const override;
+    int get_value_int(unsigned index) const override;
+    int64_t get_value_int64(unsigned index) const override;
+    double get_value_double(unsigned index) const override;
+    std::string_view get_value_string_view(unsigned index) const override;
+    blob_span get_value_blob_span(unsigned index) const override;
+    bool is_null(unsigned index) const override;
+};
+
+// Buffered resultset storing its cells in a flat array.
+// String and blob payloads are bump-allocated in a monotonic arena owned by
+// the resultset and released all at once when it is destroyed.
 class generic_buffered_resultset : public buffered_resultset
 {
 protected:
+    friend class buffered_row;
 
     struct column_info {
         std::string name;
@@ -98,14 +190,38 @@ protected:
         std::string table_origin_name;
     };
 
+    // Scalars are stored inline, strings and blobs point into the arena
+    struct cell {
+        value_type type = value_type::NULL_VALUE;
+        size_t size = 0;
+        union {
+            bool b;
+            int i;
+            int64_t l;
+            double d;
+            const char* data;
+        };
+        cell() : l(0) {}
+    };
+
     std::vector<column_info> _columns;
-    std::vector<generic_row> _rows;
+    std::vector<cell> _cells;
+    std::vector<buffered_row> _rows;
+    size_t _row_start = 0;
 
-    unsigned long long _affected_rows;
-    unsigned long long _last_insert_id;
+    std::pmr::monotonic_buffer_resource _arena;
+
+    unsigned long long _affected_rows = 0;
+    unsigned long long _last_insert_id = 0;
+
+    const char* store(const void* data, size_t size);
+    const cell* get_cell(size_t first, size_t size, unsigned index) const;
 
 public:
     generic_buffered_resultset() = default;
+    explicit generic_buffered_resultset(std::pmr::memory_resource* upstream) : _arena(upstream) {}
+    generic_buffered_resultset(const generic_buffered_resultset&) = delete;
+    generic_buffered_resultset& operator=(const generic_buffered_resultset&) = delete;
     ~generic_buffered_resultset() override = default;
 
 
@@ -113,9 +229,14 @@ public:
         _columns.push_back(column_info{.name = name, .type = type, .index = _columns.size(), .origin_name = origin_name, .table_origin_name = table_origin_name});
     }
 
-    void add_row(const generic_row& row) {
-        _rows.push_back(row);
-    }
+    void add_row(const generic_row& row);
+    void add_row(const row_base& row);
+
+    // Incremental row building: append the row cells then call end_row()
+    void add_value(const value& val);
+    void add_string(std::string_view str);
+    void add_blob(blob_span data);
+    void end_row();
 
     void affected_rows(unsigned long long affected_rows) {
         _affected_rows = affected_rows;
@@ -175,10 +296,10 @@ public:
 class generic_buffered_resultset_row_iterator_impl : public resultset_row_iterator_impl
 {
 protected:
-    std::vector<generic_row>::const_iterator _iter;
-    std::vector<generic_row>::const_iterator _end;
+    std::vector<buffered_row>::const_iterator _iter;
+    std::vector<buffered_row>::const_iterator _end;
 public:
-    generic_buffered_resultset_row_iterator_impl(std::vector<generic_row>::const_iterator iter, std::vector<generic_row>::const_iterator end) : _iter(iter), _end(end) {}
+    generic_buffered_resultset_row_iterator_impl(std::vector<buffered_row>::const_iterator iter, std::vector<buffered_row>::const_iterator end) : _iter(iter), _end(end) {}
     ~generic_buffered_resultset_row_iterator_impl() override = default;
 
     const row_base& get() const override;
@@ -187,6 +308,130 @@ public:
 };
 
 
+class columnar_buffered_resultset;
+
+// Row view over a columnar_buffered_resultset row
+class columnar_row : public row_base
+{
+protected:
+    const columnar_buffered_resultset* _resultset = nullptr;
+    unsigned long long _row = 0;
+
+public:
+    columnar_row() = default;
+    columnar_row(const columnar_buffered_resultset* resultset, unsigned long long row) : _resultset(resultset), _row(row) {}
+    ~columnar_row() override = default;
+
+    void set(unsigned long long row) { _row = row; }
+    unsigned long long row() const { return _row; }
+
+    size_t size() const override;
+
+    value get_value(unsigned index) const override;
+
+    std::string get_value_string(unsigned index) const override;
+    blob get_value_blob(unsigned index) const override;
+    bool get_value_bool(unsigned index) const override;
+    int get_value_int(unsigned index) const override;
+    int64_t get_value_int64(unsigned index) const override;
+    double get_value_double(unsigned index) const override;
+    std::string_view get_value_string_view(unsigned index) const override;
+    blob_span get_value_blob_span(unsigned index) const override;
+    bool is_null(unsigned index) const override;
+};
+
+class columnar_buffered_resultset : public columnar_resultset
+{
+protected:
+    friend class columnar_row;
+
+    struct column_info {
+        std::string name;
+        value_type type;
+        std::string origin_name;
+        std::string table_origin_name;
+
+        value_type storage = value_type::NULL_VALUE;
+        std::vector<uint8_t> validity;
+        std::vector<uint8_t> bools;
+        std::vector<int> ints;
+        std::vector<int64_t> int64s;
+        std::vector<double> doubles;
+        // Arena offsets and sizes of STRING and BLOB values
+        std::vector<size_t> offsets;
+        std::vector<size_t> sizes;
+        // Values of UNSUPPORTED (mixed) storage columns
+        std::vector<value> values;
+    };
+
+    std::vector<column_info> _columns;
+    std::vector<char> _arena;
+    unsigned long long _row_count = 0;
+
+    unsigned long long _affected_rows = 0;
+    unsigned long long _last_insert_id = 0;
+
+    mutable columnar_row _current_row{this, 0};
+
+    void add_value(column_info& column, const value& val);
+    void add_data(column_info& column, std::string_view data);
+    void set_storage(column_info& column, value_type storage);
+    std::string_view data(const column_info& column, unsigned long long row) const;
+    value column_value(const column_info& column, unsigned long long row) const;
+
+public:
+    columnar_buffered_resultset() = default;
+    ~columnar_buffered_resultset() override = default;
+
+    void add_column(const std::string& name, value_type type, const std::string& origin_name, const std::string& table_origin_name);
+    void add_row(const row_base& row);
+
+    void affected_rows(unsigned long long affected_rows) { _affected_rows = affected_rows; }
+    unsigned long long affected_rows() const override { return _affected_rows; }
+
+    void last_insert_id(unsigned long long last_insert_id) { _last_insert_id = last_insert_id; }
+    unsigned long long last_insert_id() const override { return _last_insert_id; }
+
+    unsigned int column_count() const override { return _columns.size(); }
+    std::string column_name(unsigned index) const override { return _columns[index].name; }
+    unsigned int column_index(const std::string &name) const override;
+    std::string column_origin_name(unsigned index) const override { return _columns[index].origin_name; }
+    std::string table_origin_name(unsigned index) const override { return _columns[index].table_origin_name; }
+    value_type column_type(unsigned index) const override { return _columns[index].type; }
+
+    bool has_row() const override { return _row_count > 0; }
+    unsigned int row_count() const override { return _row_count; }
+
+    const row_base& get_row(unsigned long long index) const override;
+
+    iterator begin() const override;
+    iterator end() const override;
+
+    value_type storage_type(unsigned int index) const override { return _columns[index].storage; }
+    span<const uint8_t> validity(unsigned int index) const override { return _columns[index].validity; }
+    span<const uint8_t> bool_values(unsigned int index) const override { return _columns[index].bools; }
+    span<const int> int_values(unsigned int index) const override { return _columns[index].ints; }
+    span<const int64_t> int64_values(unsigned int index) const override { return _columns[index].int64s; }
+    span<const double> double_values(unsigned int index) const override { return _columns[index].doubles; }
+    std::string_view string_value(unsigned int index, unsigned long long row) const override;
+    blob_span blob_value(unsigned int index, unsigned long long row) const override;
+};
+
+class columnar_buffered_resultset_row_iterator_impl : public resultset_row_iterator_impl
+{
+protected:
+    columnar_row _row;
+    unsigned long long _end;
+public:
+    columnar_buffered_resultset_row_iterator_impl(const columnar_buffered_resultset* resultset, unsigned long long row, unsigned long long end) : _row(resultset, row), _end(end) {}
+    ~columnar_buffered_resultset_row_iterator_impl() override = default;
+
+    const row_base& get() const override;
+    bool next() override;
+    bool different(const resultset_row_iterator_impl &other) const override;
+};
+
+
 class connection_factory
 {
 protected:
@@ -31,7 +31,10 @@ class connection : public sqlcpp::connection
 protected:
     std::shared_ptr<MYSQL> _db;
 
-    std::shared_ptr<mysql_statement> _last_stmt;
+    // Statement whose results may still be pending on the connection, shared with the statements
+    std::shared_ptr<std::weak_ptr<mysql_statement>> _active_stmt;
+
+    unsigned long _cursor_prefetch_rows = 0;
 
 public:
     static std::shared_ptr<connection> create(const std::string& connection_string);
@@ -42,11 +45,20 @@ public:
                                               const std::string& password);
 
     connection(MYSQL* db);
-    virtual ~connection() = default;
+    virtual ~connection();
 
     std::shared_ptr<sqlcpp::statement> prepare(const std::string& sql) override;
     std::shared_ptr<stats_result> execute(const std::string& sql) override;
 
+    // Ping the server, reconnecting if the client is configured to
+    bool is_valid() override;
+
+    // Server-side cursor of statements prepared from now on. 0 (default) streams whole results from the server,
+    // greater values open a read-only cursor and fetch rows by chunks of this size, using bounded client memory.
+    // Statements with an open cursor do not block the connection for other queries.
+    unsigned long cursor_prefetch_rows() const;
+    void cursor_prefetch_rows(unsigned long rows);
+
 };
 
 void register_connection_factory();
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2024-2025 Emilien Kia <emilien.kia+dev@gmail.com>
+ *
+ * sqlcpp is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlcpp is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.";
+ */
+#ifndef SQLCPP_POOL_HPP
+#define SQLCPP_POOL_HPP
+
+#include "sqlcpp.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace sqlcpp
+{
+
+struct connection_pool_options
+{
+    // Connections opened when creating the pool and kept open by idle eviction
+    size_t min_size = 0;
+    // Maximum number of open connections, leased or idle
+    size_t max_size = 16;
+    // Maximum time to wait for a connection when the pool is exhausted
+    std::chrono::milliseconds checkout_timeout = std::chrono::seconds(30);
+    // Idle connections unused for longer are closed, 0 to keep them
+    std::chrono::milliseconds idle_timeout = std::chrono::minutes(10);
+    // Idle connections unused for longer are checked with connection::is_valid() before being leased, 0 to always check
+    std::chrono::milliseconds validation_interval = std::chrono::seconds(30);
+};
+
+// Thread-safe pool of connections to the same database.
+// Connections are leased with acquire() and given back to the pool when their lease is destroyed.
+// Pools must be owned by a std::shared_ptr (see create()), leases keep their pool alive.
+class connection_pool : public std::enable_shared_from_this<connection_pool>
+{
+public:
+    typedef std::chrono::steady_clock clock;
+    typedef std::function<std::shared_ptr<connection>()> factory_t;
+
+    // RAII handle on a leased connection
+    class lease
+    {
+    protected:
+        std::shared_ptr<connection_pool> _pool;
+        std::shared_ptr<connection> _connection;
+
+    public:
+        lease() = default;
+        lease(std::shared_ptr<connection_pool> pool, std::shared_ptr<connection> conn);
+        lease(const lease&) = delete;
+        lease(lease&& other) noexcept = default;
+        ~lease();
+
+        lease& operator=(const lease&) = delete;
+        lease& operator=(lease&& other) noexcept;
+
+        explicit operator bool() const { return !!_connection; }
+        connection* operator->() const { return _connection.get(); }
+        connection& operator*() const { return *_connection; }
+        const std::shared_ptr<connection>& get() const { return _connection; }
+
+        // Give the connection back to the pool
+        void release();
+        // Close the connection instead of giving it back, when it is known to be broken
+        void invalidate();
+    };
+
+protected:
+    struct idle_connection {
+        std::shared_ptr<connection> conn;
+        clock::time_point since;
+    };
+
+    factory_t _factory;
+    connection_pool_options _options;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _available;
+    // Idle connections, most recently used at the back
+    std::deque<idle_connection> _idle;
+    // Open connections, leased or idle, including the ones being opened
+    size_t _size = 0;
+
+    void give_back(std::shared_ptr<connection> conn, bool valid);
+    std::vector<std::shared_ptr<connection>> take_expired(clock::time_point now);
+
+public:
+    connection_pool(factory_t factory, const connection_pool_options& options = {});
+    virtual ~connection_pool() = default;
+
+    // Pool of connections created by connection::create(connection_string)
+    static std::shared_ptr<connection_pool> create(const std::string& connection_string, const connection_pool_options& options = {});
+    static std::shared_ptr<connection_pool> create(factory_t factory, const connection_pool_options& options = {});
+
+    // Lease a connection, waiting at most the checkout timeout when the pool is exhausted.
+    // Return an empty lease on timeout or when a new connection cannot be opened.
+    // Exceptions thrown by the factory are propagated, after releasing the slot reserved for the connection.
+    lease acquire();
+    lease acquire(std::chrono::milliseconds timeout);
+    // Lease a connection only if one is idle or can be opened without waiting
+    lease try_acquire();
+
+    // Close connections idle for longer than the idle timeout, keeping at least min_size open connections.
+    // Also done on each acquisition.
+    void evict_idle();
+
+    const connection_pool_options& options() const { return _options; }
+    size_t size() const;
+    size_t idle_count() const;
+};
+
+} // namespace sqlcpp
+#endif // SQLCPP_POOL_HPP
@@ -22,11 +22,117 @@
 
 #include <postgresql/libpq-fe.h>
 
+#include <limits>
 #include <string>
-#
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 namespace sqlcpp::postgresql
 {
+    // Pipeline of prepared statement executions, sent without waiting for their results.
+    // Statements are executed with their current bindings when queued, so they can be rebound and queued again.
+    // Results are collected when synchronizing, or automatically each max_pending queued executions.
+    // The connection cannot run other queries while the pipeline is alive.
+    class pipeline
+    {
+    protected:
+        std::shared_ptr<PGconn> _db;
+        unsigned int _max_pending;
+        unsigned int _pending = 0;
+        std::vector<std::shared_ptr<stats_result>> _results;
+
+        void process_pending();
+
+    public:
+        pipeline(std::shared_ptr<PGconn> db, unsigned int max_pending);
+        virtual ~pipeline();
+
+        pipeline& execute(sqlcpp::statement& stmt);
+
+        // Wait for all queued executions and return their results in order, null for failed ones
+        std::vector<std::shared_ptr<stats_result>> sync();
+    };
+
+    // Bulk loader writing rows with COPY ... FROM STDIN.
+    // Rows are sent in binary COPY format when all columns have a supported type (BOOL, INT2/4/8, FLOAT4/8,
+    // text types and BYTEA), in text COPY format otherwise. Values are converted to the column types.
+    // Rows are buffered and sent each time the buffer exceeds its size, rows with invalid values are dropped.
+    // The connection cannot run other queries until the copy is finished or the writer destroyed (the copy is then aborted).
+    class copy_writer
+    {
+    protected:
+        std::shared_ptr<PGconn> _db;
+        std::vector<Oid> _types;
+        bool _binary;
+        size_t _buffer_size;
+        std::string _buffer;
+        bool _active = true;
+        unsigned long long _rows = 0;
+
+        // Current row state
+        size_t _row_start = 0;
+        size_t _field = 0;
+        bool _row_error = false;
+
+        void begin_row();
+        void end_row();
+        Oid current_type() const;
+        Oid next_field();
+        void invalid_field(Oid oid);
+        void append_binary(const char* data, size_t size);
+        void append_text(std::string_view str);
+        bool flush();
+
+        void add_field(std::nullptr_t);
+        void add_field(std::string_view value);
+        void add_field(const std::string& value);
+        void add_field(const char* value);
+        void add_field(const blob& value);
+        void add_field(bool value);
+        void add_field(int value);
+        void add_field(int64_t value);
+        void add_field(double value);
+        void add_field(const value& value);
+
+        // Other integral types (unsigned, size_t, long long...), converted to int64_t
+        template<typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>
+                && !std::is_same_v<T, int> && !std::is_same_v<T, int64_t>, int> = 0>
+        void add_field(T value)
+        {
+            if constexpr (std::is_unsigned_v<T> && sizeof(T) >= sizeof(int64_t)) {
+                if(value > static_cast<T>(std::numeric_limits<int64_t>::max())) {
+                    invalid_field(next_field());
+                    return;
+                }
+            }
+            add_field(static_cast<int64_t>(value));
+        }
+
+    public:
+        copy_writer(std::shared_ptr<PGconn> db, std::vector<Oid> types, bool binary, size_t buffer_size);
+        virtual ~copy_writer();
+
+        // Whether rows are sent in binary COPY format
+        bool binary() const;
+
+        copy_writer& write_row(const std::vector<value>& values);
+        copy_writer& write_row(std::initializer_list<value> values);
+
+        // Write a row from typed values, without intermediate sqlcpp::value
+        template<typename... Args>
+        copy_writer& write(const Args&... args)
+        {
+            begin_row();
+            (add_field(args), ...);
+            end_row();
+            return *this;
+        }
+
+        // Send remaining rows and end the copy, return null on failure
+        std::shared_ptr<stats_result> finish();
+    };
+
     class connection : public sqlcpp::connection
     {
     protected:
@@ -34,6 +140,10 @@ namespace sqlcpp::postgresql
 
         std::shared_ptr<PGconn> _db;
 
+        bool _binary_results = false;
+        bool _binary_parameters = false;
+        unsigned int _streaming_rows = 0;
+
     public:
         connection(PGconn* db);
         virtual ~connection();
@@ -43,6 +153,37 @@ namespace sqlcpp::postgresql
         std::shared_ptr<stats_result> execute(const std::string& query) override;
 
         std::shared_ptr<sqlcpp::statement> prepare(const std::string& query) override;
+
+        // Send an empty query to check the server is still reachable
+        bool is_valid() override;
+
+        std::shared_ptr<pipeline> start_pipeline(unsigned int max_pending = 1000);
+
+        // Start a bulk load into table, for the given columns or all of them if empty (see copy_writer)
+        std::shared_ptr<copy_writer> copy_from(const std::string& table, const std::vector<std::string>& columns = {}, size_t buffer_size = 64 * 1024);
+
+        // Export query results with COPY (...) TO STDOUT, calling func for each row.
+        // Rows are received in binary COPY format when all columns have a supported type, in text COPY format otherwise.
+        // Rows are only valid during the callback, return null on failure.
+        std::shared_ptr<stats_result> copy_to(const std::string& query, std::function<void(const row_base&)> func);
+
+        // Result format of statements prepared from now on: text (default) or binary.
+        // Binary results are decoded without parsing for BOOL, INT2/4/8, FLOAT4/8 and BYTEA columns.
+        // Statements returning columns of any other type (NUMERIC, TIMESTAMP...) keep the text format.
+        bool binary_results() const;
+        void binary_results(bool binary);
+
+        // Parameter format of statements prepared from now on: text (default) or binary.
+        // Binary parameters are sent with their native representation and explicit length, blobs are not hex-encoded.
+        bool binary_parameters() const;
+        void binary_parameters(bool binary);
+
+        // Row streaming of cursor and callback executions of statements prepared from now on.
+        // 0 (default) retrieves whole results at once, 1 retrieves rows one by one and greater values
+        // retrieve rows by chunks of this size (libpq 17+, one by one otherwise).
+        // The connection cannot run other queries until a streamed result is fully consumed or destroyed.
+        unsigned int streaming_rows() const;
+        void streaming_rows(unsigned int chunk_size);
     };
 
     void register_connection_factory();
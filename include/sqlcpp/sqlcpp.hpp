@@ -19,14 +19,22 @@
 #define SQLCPP_HPP
 
 
+#include <algorithm>
+#include <chrono>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <iterator>
+#include <list>
 #include <optional>
+#include <unordered_map>
 #include <vector>
 #include <variant>
 #include <string>
 #include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include "sqlcpp.hpp"
 
@@ -37,20 +45,73 @@ class statement;
 class stats_result;
 class cursor_resultset;
 class buffered_resultset;
+class columnar_resultset;
 class resultset_row_iterator;
 class resultset_row_iterator_impl;
 class row_base;
 
+namespace details {
+class query_observation;
+}
+
+// Receives the metrics of a connection, see connection::observer().
+// Callbacks are invoked synchronously by the thread using the connection, an observer shared between connections
+// (of a pool for example) must be thread-safe. Durations are measured with std::chrono::steady_clock.
+class connection_observer
+{
+public:
+    virtual ~connection_observer() = default;
+
+    // Statement prepared, or reused from the statement cache (see connection::prepare_cached()).
+    virtual void on_prepare(const std::string& /*query*/, std::chrono::nanoseconds /*duration*/, bool /*cache_hit*/) {}
+    // Query or statement executed, until its first results are available.
+    virtual void on_execute(const std::string& /*query*/, std::chrono::nanoseconds /*duration*/) {}
+    // Results of an execution released: rows read, sizes of their non-NULL values as received (see row_base::value_size())
+    // and duration from the end of the execution until the results are released.
+    virtual void on_fetch(const std::string& /*query*/, unsigned long long /*rows*/, unsigned long long /*bytes*/, std::chrono::nanoseconds /*duration*/) {}
+};
+
 class connection
 {
 protected:
     connection() = default;
 
+    // Observer of the statements prepared from now on, null when disabled
+    std::shared_ptr<connection_observer> _observer;
+    // Observation of a prepare or query execution, null when disabled
+    std::shared_ptr<details::query_observation> observe(const std::string& query) const;
+
+    // Cached statements by query, most recently used first
+    typedef std::list<std::pair<std::string, std::shared_ptr<statement>>> statement_cache_t;
+    statement_cache_t _statement_cache;
+    std::unordered_map<std::string, statement_cache_t::iterator> _statement_cache_index;
+    size_t _statement_cache_capacity = 64;
+
 public:
     virtual ~connection() = default;
     static std::shared_ptr<connection> create(const std::string& connection_string);
     virtual std::shared_ptr<stats_result> execute(const std::string& query) = 0;
     virtual std::shared_ptr<statement> prepare(const std::string& query) = 0;
+    // Check that the connection is still usable, may do a round trip to the server
+    virtual bool is_valid();
+
+    // Prepare a statement, or reuse the one already prepared for the same query.
+    // Reused statements are reset (see statement::reset()) so they must not be shared between concurrent executions.
+    // The least recently used statement is released when the cache is full.
+    // Changing a setting applied to statements at preparation (observer, driver formats, streaming or cursor modes)
+    // clears the cache, so cached statements always match the current settings.
+    std::shared_ptr<statement> prepare_cached(const std::string& query);
+
+    // Maximum number of cached statements, 0 disables the cache
+    size_t statement_cache_capacity() const;
+    void statement_cache_capacity(size_t capacity);
+    size_t statement_cache_size() const;
+    void clear_statement_cache();
+
+    // Observer of prepares, executions and fetches of the statements prepared from now on (and of direct queries).
+    // Null (the default) disables observation, at the cost of a pointer test in instrumented paths.
+    std::shared_ptr<connection_observer> observer() const;
+    void observer(std::shared_ptr<connection_observer> observer);
 };
 
 enum value_type {
@@ -68,6 +129,36 @@ enum value_type {
 typedef std::vector<unsigned char> blob;
 typedef std::variant<std::monostate, std::nullptr_t, std::string, blob, bool, int, int64_t, double> value;
 
+// Minimal non-owning view over contiguous elements, like C++20 std::span
+template<typename T>
+class span
+{
+protected:
+    T* _data = nullptr;
+    size_t _size = 0;
+
+public:
+    typedef T element_type;
+    typedef std::remove_cv_t<T> value_type;
+    typedef T* iterator;
+
+    constexpr span() = default;
+    constexpr span(T* data, size_t size) : _data(data), _size(size) {}
+    template<typename C, typename = std::enable_if_t<std::is_convertible_v<decltype(std::declval<C&>().data()), T*>>>
+    constexpr span(C& container) : _data(container.data()), _size(container.size()) {}
+
+    constexpr T* data() const { return _data; }
+    constexpr size_t size() const { return _size; }
+    constexpr bool empty() const { return _size == 0; }
+
+    constexpr T& operator[](size_t index) const { return _data[index]; }
+
+    constexpr iterator begin() const { return _data; }
+    constexpr iterator end() const { return _data + _size; }
+};
+
+typedef span<const unsigned char> blob_span;
+
 inline bool is_null(const value& v) {
     return std::holds_alternative<std::nullptr_t>(v);
 }
@@ -91,6 +182,10 @@ std::optional<int> to_int_opt(const value& val);
 std::optional<int64_t> to_int64_opt(const value& val);
 std::optional<double> to_double_opt(const value& val);
 
+// Views of string and blob values (either way), empty for other values
+std::string_view to_string_view(const value& val);
+blob_span to_blob_span(const value& val);
+
 
 template<typename T>
 T as(const value& val);
@@ -104,12 +199,47 @@ class statement
 protected:
     statement() = default;
 
+    friend class details::query_observation;
+
+    // Observer of the connection when prepared, and query of the statement, see connection::observer()
+    std::shared_ptr<connection_observer> _observer;
+    std::string _query;
+    // Observation of an execution, null when disabled
+    std::shared_ptr<details::query_observation> observe() const;
+
+    // Parameter array bound with bind_array(), values are not owned
+    struct array_param {
+        enum type_t { BOOL, INT, INT64, DOUBLE, STRING, STRING_VIEW, BLOB };
+        unsigned int index;
+        type_t type;
+        const void* data;
+        size_t size;
+        span<const uint8_t> nulls;
+
+        bool is_null(size_t row) const { return row < nulls.size() && nulls[row] != 0; }
+        template<typename T>
+        const T& get(size_t row) const { return static_cast<const T*>(data)[row]; }
+    };
+    std::vector<array_param> _array_params;
+
+    statement& bind_array(unsigned int index, array_param::type_t type, const void* data, size_t size, span<const uint8_t> nulls);
+    // Row count of the bound parameter arrays, none if there are no arrays or their sizes differ
+    std::optional<size_t> array_size() const;
+    // Bind the values of a row of the parameter arrays as scalar parameters
+    void bind_array_row(size_t row);
+
 public:
     virtual ~statement() = default;
 
     virtual std::shared_ptr<cursor_resultset> execute() = 0;
     virtual void execute(std::function<void(const row_base&)> func) = 0;
     virtual std::shared_ptr<buffered_resultset> execute_buffered() = 0;
+    // Buffered execution with values stored by column, see columnar_resultset
+    virtual std::shared_ptr<columnar_resultset> execute_columnar();
+
+    // Statements can be executed again with their current bindings, previous results are then invalidated.
+    // Make the statement ready for a new execution: pending results are released and bindings cleared (NULL).
+    virtual void reset();
 
     virtual unsigned int parameter_count() const = 0;
     virtual int parameter_index(const std::string& name) const = 0;
@@ -136,6 +266,40 @@ public:
     virtual statement& bind(unsigned int index, int64_t value) = 0;
     virtual statement& bind(unsigned int index, double value) = 0;
     virtual statement& bind(unsigned int index, const value& value) = 0;
+
+    // Bind a string or blob without copying it, where the driver supports it.
+    // The value must stay valid and unchanged until the last execution using it.
+    virtual statement& bind_ref(unsigned int index, const std::string_view& value);
+    virtual statement& bind_ref(unsigned int index, const blob_span& value);
+
+    // Bind an array of values to a parameter, for execute_array().
+    // nulls optionally flags NULL values, one byte per row, non-zero for NULL.
+    // Arrays are not copied and must stay valid until executed.
+    statement& bind_array(unsigned int index, span<const bool> values, span<const uint8_t> nulls = {});
+    statement& bind_array(unsigned int index, span<const int> values, span<const uint8_t> nulls = {});
+    statement& bind_array(unsigned int index, span<const int64_t> values, span<const uint8_t> nulls = {});
+    statement& bind_array(unsigned int index, span<const double> values, span<const uint8_t> nulls = {});
+    statement& bind_array(unsigned int index, span<const std::string> values, span<const uint8_t> nulls = {});
+    statement& bind_array(unsigned int index, span<const std::string_view> values, span<const uint8_t> nulls = {});
+    statement& bind_array(unsigned int index, span<const blob> values, span<const uint8_t> nulls = {});
+
+    // Execute the statement once for each row of the bound parameter arrays, all arrays must have the same size.
+    // Scalar bindings of the other parameters are used for all rows.
+    // Drivers run the rows in one transaction, unless one is already open, and return null if any row fails.
+    // The generic implementation executes the rows one by one.
+    virtual std::shared_ptr<stats_result> execute_array();
+
+    // Execute and decode each row into T, a std::tuple or an aggregate struct with one field per column, in order.
+    // Fields can be bool, int, int64_t, double, std::string, blob, value or std::optional of them (empty for NULL).
+    // Column types are checked once against the fields, rows are then read with the typed getters, without value.
+    // Fields must not be narrower than their columns: int only accepts INT columns and bool only BOOL columns.
+    // Nothing is returned (std::nullopt) if the execution fails or if the columns do not match the fields.
+    template<typename T>
+    std::optional<std::vector<T>> execute_as();
+    // Same, calling func(const T&) for each row. Fields can also be std::string_view and blob_span, valid during the call.
+    // Returns false, without calling func, if the execution fails or if the columns do not match the fields.
+    template<typename T, typename F>
+    bool execute_as(F&& func);
 };
 
 class row_base
@@ -158,6 +322,21 @@ public:
     virtual int64_t get_value_int64(unsigned int index) const = 0;
     virtual double get_value_double(unsigned int index) const = 0;
 
+    // Non-owning views of string and blob values (either way), valid until the row changes (cursor advance).
+    // Views of other values, including null, are empty.
+    virtual std::string_view get_value_string_view(unsigned int index) const = 0;
+    virtual blob_span get_value_blob_span(unsigned int index) const = 0;
+
+    // Test for NULL without retrieving the value
+    virtual bool is_null(unsigned int index) const;
+
+    // Type of a value without retrieving it, NULL_VALUE for null
+    virtual value_type get_value_type(unsigned int index) const;
+
+    // Size of a value as received from the database, without decoding it: length of strings and blobs,
+    // 8 bytes for other values, 0 for NULL.
+    virtual size_t value_size(unsigned int index) const;
+
     virtual std::vector<value> get_values() const;
 };
 
@@ -184,6 +363,11 @@ public:
     int get_value_int(unsigned int index) const override {return _row->get_value_int(index);}
     int64_t get_value_int64(unsigned int index) const override {return _row->get_value_int64(index);}
     double get_value_double(unsigned int index) const override {return _row->get_value_double(index);}
+    std::string_view get_value_string_view(unsigned int index) const override {return _row->get_value_string_view(index);}
+    blob_span get_value_blob_span(unsigned int index) const override {return _row->get_value_blob_span(index);}
+    bool is_null(unsigned int index) const override {return _row->is_null(index);}
+    value_type get_value_type(unsigned int index) const override {return _row->get_value_type(index);}
+    size_t value_size(unsigned int index) const override {return _row->value_size(index);}
     std::vector<value> get_values() const override { return _row->get_values(); }
 };
 
@@ -204,9 +388,14 @@ class resultset_row_iterator : public std::input_iterator_tag
 protected:
     std::shared_ptr<resultset_row_iterator_impl> _impl;
     mutable row _row{nullptr};
+    // Observation of the execution, counting rows when first read
+    std::shared_ptr<details::query_observation> _observation;
+
+    const row& current() const;
 
 public:
-    resultset_row_iterator(std::shared_ptr<resultset_row_iterator_impl>&& impl) : _impl(std::move(impl)) {}
+    resultset_row_iterator(std::shared_ptr<resultset_row_iterator_impl>&& impl, std::shared_ptr<details::query_observation> observation = {}) :
+        _impl(std::move(impl)), _observation(std::move(observation)) {}
 
     using value_type = row;
 
@@ -226,6 +415,90 @@ public:
     const row& operator->() const;
 };
 
+// Caller buffers receiving a column in cursor_resultset::fetch_batch(): values converted to int64_t or double,
+// and an optional validity bitmap with bit (row % 8) of byte (row / 8) set for non-null values. Null values are zero.
+class batch_column
+{
+protected:
+    unsigned int _index;
+    value_type _type;
+    void* _data;
+    size_t _size;
+    span<uint8_t> _validity;
+
+public:
+    batch_column(unsigned int index, span<int64_t> values, span<uint8_t> validity = {}) :
+        _index(index), _type(INT64), _data(values.data()), _size(values.size()), _validity(validity) {}
+    batch_column(unsigned int index, span<double> values, span<uint8_t> validity = {}) :
+        _index(index), _type(DOUBLE), _data(values.data()), _size(values.size()), _validity(validity) {}
+
+    unsigned int index() const { return _index; }
+    value_type type() const { return _type; }
+
+    // Row count the buffers can hold, the smallest of the columns
+    static size_t capacity(span<const batch_column> columns) {
+        if (columns.empty()) {
+            return 0;
+        }
+        size_t capacity = std::numeric_limits<size_t>::max();
+        for (const auto& column : columns) {
+            capacity = std::min(capacity, column._size);
+            if (!column._validity.empty()) {
+                capacity = std::min(capacity, column._validity.size() * 8);
+            }
+        }
+        return capacity;
+    }
+
+    void set_valid(size_t row, bool valid) const {
+        if (!_validity.empty()) {
+            if (valid) {
+                _validity[row / 8] |= (1u << (row % 8));
+            } else {
+                _validity[row / 8] &= ~(1u << (row % 8));
+            }
+        }
+    }
+
+    void set_null(size_t row) const {
+        if (_type == INT64) {
+            static_cast<int64_t*>(_data)[row] = 0;
+        } else {
+            static_cast<double*>(_data)[row] = 0;
+        }
+        set_valid(row, false);
+    }
+
+    void set(size_t row, int64_t value) const {
+        if (_type == INT64) {
+            static_cast<int64_t*>(_data)[row] = value;
+        } else {
+            static_cast<double*>(_data)[row] = static_cast<double>(value);
+        }
+        set_valid(row, true);
+    }
+
+    void set(size_t row, double value) const {
+        if (_type == INT64) {
+            static_cast<int64_t*>(_data)[row] = static_cast<int64_t>(value);
+        } else {
+            static_cast<double*>(_data)[row] = value;
+        }
+        set_valid(row, true);
+    }
+
+    // Copy the column value of a row, with the typed getters
+    void set(size_t row, const row_base& src) const {
+        if (src.is_null(_index)) {
+            set_null(row);
+        } else if (_type == INT64) {
+            set(row, src.get_value_int64(_index));
+        } else {
+            set(row, src.get_value_double(_index));
+        }
+    }
+};
+
 class stats_result
 {
 public:
@@ -240,8 +513,15 @@ class cursor_resultset : public stats_result
 protected:
     cursor_resultset() = default;
 
-    static resultset_row_iterator create_iterator(std::shared_ptr<resultset_row_iterator_impl>&& impl) {
-        return {std::move(impl)};
+    // Observation of the execution, reported when the resultset and its iterators are released
+    std::shared_ptr<details::query_observation> _observation;
+
+    // Next row of the generic fetch_batch(), once started
+    resultset_row_iterator _batch_iterator;
+    bool _batch_started = false;
+
+    resultset_row_iterator create_iterator(std::shared_ptr<resultset_row_iterator_impl>&& impl) const {
+        return {std::move(impl), _observation};
     }
 
 public:
@@ -249,6 +529,9 @@ public:
 
     virtual ~cursor_resultset() = default;
 
+    // Attach the observation of the execution, set by drivers
+    void observe(std::shared_ptr<details::query_observation> observation) { _observation = std::move(observation); }
+
     virtual unsigned int column_count() const = 0;
 
     virtual std::string column_name(unsigned int index) const = 0;
@@ -263,6 +546,10 @@ public:
     virtual iterator begin() const =0;
     virtual iterator end() const =0;
 
+    // Fetch the next rows into the column buffers, as many as they can hold, from their first row.
+    // Returns the count of fetched rows, 0 when all rows are fetched. Not to be mixed with iterators.
+    // The generic implementation reads the rows with an iterator, drivers override it to read values directly.
+    virtual size_t fetch_batch(span<const batch_column> columns);
 };
 
 class buffered_resultset : public cursor_resultset
@@ -270,10 +557,45 @@ class buffered_resultset : public cursor_resultset
 protected:
     buffered_resultset() = default;
 
+    // Next row of fetch_batch()
+    unsigned long long _batch_row = 0;
+
 public:
     virtual unsigned int row_count() const = 0;
 
     virtual const row_base& get_row(unsigned long long index) const = 0;
+
+    size_t fetch_batch(span<const batch_column> columns) override;
+};
+
+// Buffered resultset storing values by column, in typed contiguous arrays with validity bitmaps.
+// String and blob values are stored in a single arena.
+// Rows returned by get_row(...) are views, valid until the next call.
+class columnar_resultset : public buffered_resultset
+{
+protected:
+    columnar_resultset() = default;
+
+public:
+    // Storage type of a column: BOOL, INT, INT64, DOUBLE, STRING or BLOB when all its values have this type,
+    // NULL_VALUE when all its values are null and UNSUPPORTED when values of different types are stored as generic values
+    virtual value_type storage_type(unsigned int index) const = 0;
+
+    // Validity bitmap of a column, bit (row % 8) of byte (row / 8) is set for non-null values
+    virtual span<const uint8_t> validity(unsigned int index) const = 0;
+    bool is_valid(unsigned int index, unsigned long long row) const {
+        return (validity(index)[row / 8] >> (row % 8)) & 1;
+    }
+
+    // Contiguous values of a column of the corresponding storage type, empty otherwise. Null values are zero.
+    virtual span<const uint8_t> bool_values(unsigned int index) const = 0;
+    virtual span<const int> int_values(unsigned int index) const = 0;
+    virtual span<const int64_t> int64_values(unsigned int index) const = 0;
+    virtual span<const double> double_values(unsigned int index) const = 0;
+
+    // Value of a STRING or BLOB storage column, from the arena. Null values are empty.
+    virtual std::string_view string_value(unsigned int index, unsigned long long row) const = 0;
+    virtual blob_span blob_value(unsigned int index, unsigned long long row) const = 0;
 };
 
 
@@ -344,6 +666,240 @@ inline std::optional<double> as(const value& val) {
 }
 
 
+//
+// Typed row decoding, see statement::execute_as()
+//
+
+namespace details {
+
+// Column types accepted by a field type, as a bit mask of value_type, and typed retrieval
+template<typename T>
+struct field_traits;
+
+template<>
+struct field_traits<bool> {
+    static constexpr unsigned accepted = (1u << BOOL);
+    static constexpr bool is_view = false;
+    static bool get(const row_base& row, unsigned int index) { return row.get_value_bool(index); }
+};
+
+template<>
+struct field_traits<int> {
+    static constexpr unsigned accepted = (1u << INT);
+    static constexpr bool is_view = false;
+    static int get(const row_base& row, unsigned int index) { return row.get_value_int(index); }
+};
+
+template<>
+struct field_traits<int64_t> {
+    static constexpr unsigned accepted = (1u << BOOL) | (1u << INT) | (1u << INT64);
+    static constexpr bool is_view = false;
+    static int64_t get(const row_base& row, unsigned int index) { return row.get_value_int64(index); }
+};
+
+template<>
+struct field_traits<double> {
+    static constexpr unsigned accepted = (1u << INT) | (1u << INT64) | (1u << DOUBLE);
+    static constexpr bool is_view = false;
+    static double get(const row_base& row, unsigned int index) { return row.get_value_double(index); }
+};
+
+template<>
+struct field_traits<std::string> {
+    static constexpr unsigned accepted = (1u << STRING) | (1u << BLOB);
+    static constexpr bool is_view = false;
+    static std::string get(const row_base& row, unsigned int index) { return std::string(row.get_value_string_view(index)); }
+};
+
+template<>
+struct field_traits<std::string_view> {
+    static constexpr unsigned accepted = (1u << STRING) | (1u << BLOB);
+    static constexpr bool is_view = true;
+    static std::string_view get(const row_base& row, unsigned int index) { return row.get_value_string_view(index); }
+};
+
+template<>
+struct field_traits<blob> {
+    static constexpr unsigned accepted = (1u << STRING) | (1u << BLOB);
+    static constexpr bool is_view = false;
+    static blob get(const row_base& row, unsigned int index) {
+        blob_span data = row.get_value_blob_span(index);
+        return blob(data.begin(), data.end());
+    }
+};
+
+template<>
+struct field_traits<blob_span> {
+    static constexpr unsigned accepted = (1u << STRING) | (1u << BLOB);
+    static constexpr bool is_view = true;
+    static blob_span get(const row_base& row, unsigned int index) { return row.get_value_blob_span(index); }
+};
+
+template<>
+struct field_traits<value> {
+    static constexpr unsigned accepted = ~0u;
+    static constexpr bool is_view = false;
+    static value get(const row_base& row, unsigned int index) { return row.get_value(index); }
+};
+
+template<typename T>
+struct field_traits<std::optional<T>> {
+    static constexpr unsigned accepted = field_traits<T>::accepted;
+    static constexpr bool is_view = field_traits<T>::is_view;
+    static std::optional<T> get(const row_base& row, unsigned int index) {
+        if(row.is_null(index)) {
+            return std::nullopt;
+        }
+        return field_traits<T>::get(row, index);
+    }
+};
+
+// Check the resultset columns against the accepted types of the fields, one per column.
+// Columns of unknown type (NULL_VALUE) are accepted.
+bool check_column_types(const cursor_resultset& rset, const std::vector<unsigned>& accepted);
+
+template<typename T>
+struct is_tuple : std::false_type {};
+template<typename... Ts>
+struct is_tuple<std::tuple<Ts...>> : std::true_type {};
+
+// Converts to any field type, to count aggregate fields by brace initialization
+struct any_field {
+    template<typename T>
+    operator T() const;
+};
+
+template<typename T, typename Seq, typename = void>
+struct is_brace_constructible : std::false_type {};
+template<typename T, size_t... I>
+struct is_brace_constructible<T, std::index_sequence<I...>, std::void_t<decltype(T{(I, any_field{})...})>> : std::true_type {};
+
+constexpr size_t max_aggregate_fields = 16;
+
+template<typename T, size_t N = max_aggregate_fields>
+constexpr size_t aggregate_field_count() {
+    if constexpr (N == 0) {
+        return 0;
+    } else if constexpr (is_brace_constructible<T, std::make_index_sequence<N>>::value) {
+        return N;
+    } else {
+        return aggregate_field_count<T, N - 1>();
+    }
+}
+
+// References to the fields of a tuple or an aggregate, as a tuple
+template<typename T>
+auto tie_fields(T& obj) {
+    if constexpr (is_tuple<T>::value) {
+        return std::apply([](auto&... fields) { return std::tie(fields...); }, obj);
+    } else {
+        static_assert(std::is_aggregate_v<T>, "Rows can only be decoded into tuples and aggregates");
+        constexpr size_t count = aggregate_field_count<T>();
+        static_assert(count > 0 && count < max_aggregate_fields, "Unsupported aggregate field count");
+        if constexpr (count == 1) {
+            auto& [f0] = obj;
+            return std::tie(f0);
+        } else if constexpr (count == 2) {
+            auto& [f0, f1] = obj;
+            return std::tie(f0, f1);
+        } else if constexpr (count == 3) {
+            auto& [f0, f1, f2] = obj;
+            return std::tie(f0, f1, f2);
+        } else if constexpr (count == 4) {
+            auto& [f0, f1, f2, f3] = obj;
+            return std::tie(f0, f1, f2, f3);
+        } else if constexpr (count == 5) {
+            auto& [f0, f1, f2, f3, f4] = obj;
+            return std::tie(f0, f1, f2, f3, f4);
+        } else if constexpr (count == 6) {
+            auto& [f0, f1, f2, f3, f4, f5] = obj;
+            return std::tie(f0, f1, f2, f3, f4, f5);
+        } else if constexpr (count == 7) {
+            auto& [f0, f1, f2, f3, f4, f5, f6] = obj;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6);
+        } else if constexpr (count == 8) {
+            auto& [f0, f1, f2, f3, f4, f5, f6, f7] = obj;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7);
+        } else if constexpr (count == 9) {
+            auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8] = obj;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8);
+        } else if constexpr (count == 10) {
+            auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9] = obj;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9);
+        } else if constexpr (count == 11) {
+            auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10] = obj;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10);
+        } else if constexpr (count == 12) {
+            auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11] = obj;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11);
+        } else if constexpr (count == 13) {
+            auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12] = obj;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12);
+        } else if constexpr (count == 14) {
+            auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13] = obj;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13);
+        } else {
+            auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14] = obj;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14);
+        }
+    }
+}
+
+// Call func(field, index) for each field of a tuple or an aggregate
+template<typename T, typename F>
+void for_each_field(T& obj, F&& func) {
+    std::apply([&](auto&... fields) {
+        unsigned int index = 0;
+        (func(fields, index++), ...);
+    }, tie_fields(obj));
+}
+
+// Decode the rows of a statement execution into T, views are refused when rows must be owned.
+// Return false if the execution fails or if the columns do not match the fields.
+template<typename T, bool owning, typename F>
+bool execute_as(statement& stmt, F&& func) {
+    T obj{};
+    std::vector<unsigned> accepted;
+    for_each_field(obj, [&](auto& field, unsigned int) {
+        using field_type = std::decay_t<decltype(field)>;
+        static_assert(!owning || !field_traits<field_type>::is_view, "Views can only be decoded with a callback");
+        accepted.push_back(field_traits<field_type>::accepted);
+    });
+
+    auto rset = stmt.execute();
+    if(!rset || !check_column_types(*rset, accepted)) {
+        return false;
+    }
+    for(const row_base& row : *rset) {
+        for_each_field(obj, [&](auto& field, unsigned int index) {
+            field = field_traits<std::decay_t<decltype(field)>>::get(row, index);
+        });
+        func(obj);
+    }
+    return true;
+}
+
+} // namespace details
+
+template<typename T>
+std::optional<std::vector<T>> statement::execute_as() {
+    std::vector<T> rows;
+    if(!details::execute_as<T, true>(*this, [&](const T& obj) {
+        rows.push_back(obj);
+    })) {
+        return std::nullopt;
+    }
+    return rows;
+}
+
+template<typename T, typename F>
+bool statement::execute_as(F&& func) {
+    return details::execute_as<T, false>(*this, [&](const T& obj) {
+        func(obj);
+    });
+}
+
+
 
 } // namespace sqlcpp
 #endif // SQLCPP_HPP
@@ -43,6 +43,8 @@ namespace sqlcpp::sqlite
 
         std::shared_ptr<sqlcpp::statement> prepare(const std::string& query) override;
 
+        bool is_valid() override;
+
     };
 
     void register_connection_factory();
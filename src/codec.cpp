@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2024-2025 Emilien Kia <emilien.kia+dev@gmail.com>
+ *
+ * sqlcpp is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlcpp is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.";
+ */
+
+#include "../include/sqlcpp/details.hpp"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SQLCPP_HEX_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * Implementation notes:
+ *
+ * Hex kernels process 16 (SSE2) or 32 (AVX2) bytes per iteration and leave
+ * the tail to the scalar loop. The kernel is chosen once from the CPU features
+ * at first use, the scalar one is used on other architectures.
+ *
+ * Decoding validates all characters: a vector block is rejected as a whole if
+ * any of its characters is not an hex digit.
+ */
+
+namespace sqlcpp
+{
+
+namespace
+{
+
+const char hex_digits[] = "0123456789abcdef";
+
+// Value of an hex digit, -1 if not an hex digit
+inline int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+void hex_encode_scalar(const unsigned char* data, size_t size, char* out)
+{
+    for (size_t i = 0; i < size; ++i) {
+        out[i * 2] = hex_digits[data[i] >> 4];
+        out[i * 2 + 1] = hex_digits[data[i] & 0x0F];
+    }
+}
+
+bool hex_decode_scalar(const char* hex, size_t size, unsigned char* out)
+{
+    for (size_t i = 0; i < size; ++i) {
+        int hi = hex_value(hex[i * 2]);
+        int lo = hex_value(hex[i * 2 + 1]);
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        out[i] = static_cast<unsigned char>((hi << 4) | lo);
+    }
+    return true;
+}
+
+#ifdef SQLCPP_HEX_X86
+
+__attribute__((target("sse2")))
+inline __m128i nibbles_to_hex_sse2(__m128i nibbles)
+{
+    // '0' + n, plus the gap between '9' and 'a' for n > 9
+    __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+}
+
+__attribute__((target("sse2")))
+void hex_encode_sse2(const unsigned char* data, size_t size, char* out)
+{
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i hi = nibbles_to_hex_sse2(_mm_and_si128(_mm_srli_epi16(bytes, 4), mask));
+        __m128i lo = nibbles_to_hex_sse2(_mm_and_si128(bytes, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    hex_encode_scalar(data + i, size - i, out + i * 2);
+}
+
+// Nibble values of 16 hex digits, all bits of invalid set for non hex digits
+__attribute__((target("sse2")))
+inline __m128i hex_to_nibbles_sse2(__m128i chars, __m128i& invalid)
+{
+    // Signed comparisons, bytes >= 0x80 end up out of both ranges
+    __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(digit, _mm_set1_epi8(-1)), _mm_cmplt_epi8(digit, _mm_set1_epi8(10)));
+    __m128i letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i is_letter = _mm_and_si128(_mm_cmpgt_epi8(letter, _mm_set1_epi8(-1)), _mm_cmplt_epi8(letter, _mm_set1_epi8(6)));
+    invalid = _mm_or_si128(invalid, _mm_andnot_si128(_mm_or_si128(is_digit, is_letter), _mm_set1_epi8(-1)));
+    return _mm_or_si128(_mm_and_si128(is_digit, digit),
+                        _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+// Pairs of nibbles (high first) into the low byte of each 16 bits lane
+__attribute__((target("sse2")))
+inline __m128i nibble_pairs_sse2(__m128i nibbles)
+{
+    return _mm_or_si128(_mm_and_si128(_mm_slli_epi16(nibbles, 4), _mm_set1_epi16(0x00F0)), _mm_srli_epi16(nibbles, 8));
+}
+
+__attribute__((target("sse2")))
+bool hex_decode_sse2(const char* hex, size_t size, unsigned char* out)
+{
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i invalid = _mm_setzero_si128();
+        __m128i first = hex_to_nibbles_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + i * 2)), invalid);
+        __m128i second = hex_to_nibbles_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + i * 2 + 16)), invalid);
+        if (_mm_movemask_epi8(invalid) != 0) {
+            return false;
+        }
+        __m128i bytes = _mm_packus_epi16(nibble_pairs_sse2(first), nibble_pairs_sse2(second));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), bytes);
+    }
+    return hex_decode_scalar(hex + i * 2, size - i, out + i);
+}
+
+__attribute__((target("avx2")))
+void hex_encode_avx2(const unsigned char* data, size_t size, char* out)
+{
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex_digits)));
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask));
+        __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(bytes, mask));
+        // Unpacking interleaves within 128 bits lanes, bytes 0-7 and 16-23 then 8-15 and 24-31
+        __m256i first = _mm256_unpacklo_epi8(hi, lo);
+        __m256i second = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2 + 32), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    hex_encode_sse2(data + i, size - i, out + i * 2);
+}
+
+__attribute__((target("avx2")))
+inline __m256i hex_to_nibbles_avx2(__m256i chars, __m256i& invalid)
+{
+    __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    __m256i is_digit = _mm256_and_si256(_mm256_cmpgt_epi8(digit, _mm256_set1_epi8(-1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(10), digit));
+    __m256i letter = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i is_letter = _mm256_and_si256(_mm256_cmpgt_epi8(letter, _mm256_set1_epi8(-1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(6), letter));
+    invalid = _mm256_or_si256(invalid, _mm256_andnot_si256(_mm256_or_si256(is_digit, is_letter), _mm256_set1_epi8(-1)));
+    return _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+                           _mm256_and_si256(is_letter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2")))
+inline __m256i nibble_pairs_avx2(__m256i nibbles)
+{
+    return _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(nibbles, 4), _mm256_set1_epi16(0x00F0)), _mm256_srli_epi16(nibbles, 8));
+}
+
+__attribute__((target("avx2")))
+bool hex_decode_avx2(const char* hex, size_t size, unsigned char* out)
+{
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i invalid = _mm256_setzero_si256();
+        __m256i first = hex_to_nibbles_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex + i * 2)), invalid);
+        __m256i second = hex_to_nibbles_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex + i * 2 + 32)), invalid);
+        if (_mm256_movemask_epi8(invalid) != 0) {
+            return false;
+        }
+        // Packing works within 128 bits lanes, put the 64 bits quarters back in order
+        __m256i bytes = _mm256_packus_epi16(nibble_pairs_avx2(first), nibble_pairs_avx2(second));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute4x64_epi64(bytes, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    return hex_decode_sse2(hex + i * 2, size - i, out + i);
+}
+
+#endif // SQLCPP_HEX_X86
+
+struct hex_kernels {
+    void (*encode)(const unsigned char*, size_t, char*);
+    bool (*decode)(const char*, size_t, unsigned char*);
+};
+
+const hex_kernels& get_hex_kernels()
+{
+    static const hex_kernels kernels = [] {
+#ifdef SQLCPP_HEX_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return hex_kernels{hex_encode_avx2, hex_decode_avx2};
+        } else if (__builtin_cpu_supports("sse2")) {
+            return hex_kernels{hex_encode_sse2, hex_decode_sse2};
+        }
+#endif
+        return hex_kernels{hex_encode_scalar, hex_decode_scalar};
+    }();
+    return kernels;
+}
+
+} // anonymous namespace
+
+//
+// Hex and bytea codecs
+//
+
+void details::hex_encode(blob_span data, char* out)
+{
+    get_hex_kernels().encode(data.data(), data.size(), out);
+}
+
+bool details::hex_decode(std::string_view hex, unsigned char* out)
+{
+    if (hex.size() % 2 != 0) {
+        return false;
+    }
+    return get_hex_kernels().decode(hex.data(), hex.size() / 2, out);
+}
+
+bool details::bytea_unescape(std::string_view str, blob& out)
+{
+    out.resize(str.size());
+    const char* src = str.data();
+    const char* end = src + str.size();
+    unsigned char* dst = out.data();
+    while (src < end) {
+        // Copy the run of plain bytes up to the next escape sequence
+        const char* escape = static_cast<const char*>(std::memchr(src, '\\', end - src));
+        size_t run = (escape ? escape : end) - src;
+        std::memcpy(dst, src, run);
+        dst += run;
+        src += run;
+        if (!escape) {
+            break;
+        }
+        if (end - src >= 2 && src[1] == '\\') {
+            *dst++ = '\\';
+            src += 2;
+        } else if (end - src >= 4 && src[1] >= '0' && src[1] <= '3'
+                   && src[2] >= '0' && src[2] <= '7' && src[3] >= '0' && src[3] <= '7') {
+            *dst++ = static_cast<unsigned char>(((src[1] - '0') << 6) | ((src[2] - '0') << 3) | (src[3] - '0'));
+            src += 4;
+        } else {
+            // Invalid escape sequence
+            return false;
+        }
+    }
+    out.resize(dst - out.data());
+    return true;
+}
+
+std::string details::blob_to_hex_string(const blob& data) {
+    std::string hex_str(data.size() * 2, '\0');
+    hex_encode(data, hex_str.data());
+    return hex_str;
+}
+
+} // namespace sqlcpp
@@ -34,6 +34,15 @@
  *
  * Implementation notes:
  * - BOOL(EAN) is just an alias for TINYINT(1), all TINYINT(1) will be considered as BOOLEAN : https://dev.mysql.com/doc/refman/9.4/en/numeric-type-syntax.html
+ * - With connection::cursor_prefetch_rows(), statements open a read-only server-side cursor (STMT_ATTR_CURSOR_TYPE)
+ *   and rows are fetched by chunks (STMT_ATTR_PREFETCH_ROWS). Other statements can run while a cursor is open.
+ * - String and blob result buffers start small (not at the declared column length, up to 4GB for LONGBLOB) and grow
+ *   when a fetch reports MYSQL_DATA_TRUNCATED: truncated cells are fetched again with mysql_stmt_fetch_column.
+ * - Buffered results are decoded once into a details::generic_buffered_resultset instead of being stored by the client
+ *   and re-fetched with mysql_stmt_data_seek on each access. They do not depend on the statement nor the connection.
+ * - Parameter arrays are sent with column-wise array binding (STMT_ATTR_ARRAY_SIZE) in a single COM_STMT_BULK_EXECUTE
+ *   when all parameters are arrays and the server supports it, rows are executed one by one otherwise,
+ *   in one transaction unless one is already open.
  */
 
 namespace sqlcpp::mariadb {
@@ -42,27 +51,8 @@ namespace {
 
 MYSQL_BIND bind0 = {.buffer_length = 42};
 
-
-blob string_to_blob(const std::string &s) {
-    blob b;
-    b.insert(b.end(), s.begin(), s.end());
-    return b;
-}
-
-blob string_to_blob(const std::string_view &s) {
-    blob b;
-    b.insert(b.end(), s.begin(), s.end());
-    return b;
-}
-
-
-template<typename T>
-blob num_to_blob(T v) {
-    blob b;
-    b.resize(b.size() + sizeof(T), 0);
-    std::memcpy(b.data() + b.size() - sizeof(T), &v, sizeof(T));
-    return b;
-}
+// Initial buffer size of string and blob results, grown on demand when a value is truncated
+constexpr unsigned long initial_result_buffer_size = 256;
 
 
 
@@ -76,15 +66,16 @@ blob num_to_blob(T v) {
 //
 
 class resultset;
+class mysql_row;
 
+// Values are read from the statement bind buffers, like mysql_row
 class resultset_row_iterator_impl : public sqlcpp::resultset_row_iterator_impl, protected row_base
 {
 protected:
     std::shared_ptr<resultset> _resultset;
 
-    std::vector<value> _current_row;
-
     void fetch_next_row();
+    mysql_row current_row() const;
 
 public:
     resultset_row_iterator_impl(std::shared_ptr<resultset> resultset);
@@ -105,82 +96,41 @@ public:
     int get_value_int(unsigned int index) const override;
     int64_t get_value_int64(unsigned int index) const override;
     double get_value_double(unsigned int index) const override;
+    std::string_view get_value_string_view(unsigned int index) const override;
+    blob_span get_value_blob_span(unsigned int index) const override;
+    bool is_null(unsigned int index) const override;
 };
 
-resultset_row_iterator_impl::resultset_row_iterator_impl(std::shared_ptr<resultset> resultset) :
-_resultset(std::move(resultset))
-{
-    fetch_next_row();
-}
-
-const row_base& resultset_row_iterator_impl::get() const
-{
-    return *this;
-}
-
-bool resultset_row_iterator_impl::next()
-{
-    fetch_next_row();
-    return _current_row.empty();
-}
-
-bool resultset_row_iterator_impl::different(const sqlcpp::resultset_row_iterator_impl& other) const
-{
-    if(auto impl = dynamic_cast<const resultset_row_iterator_impl*>(&other) ; impl!=nullptr) {
-        return _resultset != impl->_resultset;
-    } else {
-        return true;
-    }
-}
-
-size_t resultset_row_iterator_impl::size() const
-{
-    return _current_row.size();
-}
-
-value resultset_row_iterator_impl::get_value(unsigned int index) const
-{
-    return _current_row[index];
-}
-
-std::string resultset_row_iterator_impl::get_value_string(unsigned int index) const
-{
-    return to_string(_current_row[index]);
-}
-
-blob resultset_row_iterator_impl::get_value_blob(unsigned int index) const
-{
-    return to_blob(_current_row[index]);
-}
-
-bool resultset_row_iterator_impl::get_value_bool(unsigned int index) const
-{
-    return to_bool(_current_row[index]);
-}
-
-int resultset_row_iterator_impl::get_value_int(unsigned int index) const
-{
-    return to_int(_current_row[index]);
-}
-
-int64_t resultset_row_iterator_impl::get_value_int64(unsigned int index) const
-{
-    return to_int64(_current_row[index]);
-}
-
-double resultset_row_iterator_impl::get_value_double(unsigned int index) const
-{
-    return to_double(_current_row[index]);
-}
-
 //
 // MySql data fetcher
 //
-class mysql_statement
+class mysql_statement : public std::enable_shared_from_this<mysql_statement>
 {
 protected:
     std::shared_ptr<MYSQL_STMT> _stmt;
+    std::shared_ptr<std::weak_ptr<mysql_statement>> _active;
     bool _executed = false;
+    bool _cursor = false;
+
+    // Parameter slot: scalars are written in place, strings and blobs are copied in a buffer
+    // whose capacity is reused across bindings, or referenced in caller memory with bind_ref
+    struct param_slot {
+        union {
+            signed char tiny;
+            int int32;
+            int64_t int64;
+            double real;
+        } scalar = {};
+        blob copy;
+        const void* ref = nullptr;
+    };
+
+    // Parameters, kept apart from the result buffers so both survive re-executions
+    std::vector<unsigned long> _param_lengths;
+    std::vector<my_bool> _param_nulls;
+    std::vector<enum_field_types> _param_types;
+    std::vector<param_slot> _param_slots;
+    std::vector<MYSQL_BIND> _param_binds;
 
     std::vector<std::string> _column_names;
     std::vector<std::string> _column_origin_names;
@@ -196,8 +146,8 @@ protected:
     std::vector<MYSQL_BIND> _binds;
 
 public:
-    mysql_statement(MYSQL_STMT* stmt) : _stmt(stmt, mysql_stmt_close) {}
-    mysql_statement(std::shared_ptr<MYSQL_STMT> stmt) : _stmt(stmt) {}
+    mysql_statement(MYSQL_STMT* stmt, std::shared_ptr<std::weak_ptr<mysql_statement>> active = {}) : _stmt(stmt, mysql_stmt_close), _active(std::move(active)) {}
+    mysql_statement(std::shared_ptr<MYSQL_STMT> stmt, std::shared_ptr<std::weak_ptr<mysql_statement>> active = {}) : _stmt(stmt), _active(std::move(active)) {}
     ~mysql_statement() {
         close();
         for(auto& bind : _binds) {
@@ -223,11 +173,20 @@ public:
         }
     }
 
-    void store_all_results();
+    // Open a read-only server-side cursor on execution, fetching prefetch_rows rows at once
+    bool use_cursor(unsigned long prefetch_rows);
+
+    // Discard the rows not fetched yet, so the connection can run other queries
+    void free_result();
+    void release_pending();
+    void set_executed();
+    // Discard pending results and clear parameters, the statement stays prepared
+    void reset();
 
     void prepare_buffers();
-    std::vector<value> fetch_next_row();
-    std::vector<value> fetch_row(unsigned long long index);
+    bool fetch();
+    // Grow the buffers of truncated columns and fetch them again
+    bool fetch_truncated();
 
     unsigned long long affected_rows() const {
         return ok() ? mysql_stmt_affected_rows(_stmt.get()) : 0;
@@ -279,15 +238,44 @@ public:
 
     value_type column_type(unsigned int index) const;
 
+    // Values of the last fetched row, read from bind buffers
+    bool is_null_result(unsigned int index) const;
+    std::string_view get_result_data(unsigned int index) const;
+    // Full length of a string or blob result, including truncated parts
+    unsigned long get_result_length(unsigned int index) const;
+    value get_result(unsigned int index) const;
+    enum_field_types result_type(unsigned int index) const { return _my_types[index]; }
+
+    // Numeric result read directly from its bind buffer, false for NULL and non numeric results
     template<typename T>
-    static inline void set(std::vector<T>& params, size_t index, const T& value, const T& def)
-    {
-        if(params.size() <= index) {
-            params.resize(index + 1, def);
+    bool get_result_number(unsigned int index, T& number) const {
+        const MYSQL_BIND &bind = _binds[index];
+        if(is_null_result(index)) {
+            return false;
+        }
+        switch(bind.buffer_type) {
+            case MYSQL_TYPE_TINY:
+                number = static_cast<T>(*(const char*)bind.buffer);
+                return true;
+            case MYSQL_TYPE_LONG:
+                number = static_cast<T>(*(const int*)bind.buffer);
+                return true;
+            case MYSQL_TYPE_LONGLONG:
+                number = static_cast<T>(*(const int64_t*)bind.buffer);
+                return true;
+            case MYSQL_TYPE_DOUBLE:
+                number = static_cast<T>(*(const double*)bind.buffer);
+                return true;
+            default:
+                return false;
         }
-        params[index] = value;
     }
 
+    // Slot of a parameter, typed and sized for the value to be bound
+    param_slot& param(unsigned int index, enum_field_types type, unsigned long length);
+    void resize_params(size_t count);
+    void* param_buffer(unsigned int index);
+
     void bind(unsigned int index, std::nullptr_t);
     void bind(unsigned int index, const std::string& value);
     void bind(unsigned int index, const std::string_view& value);
@@ -297,41 +285,172 @@ public:
     void bind(unsigned int index, int64_t value);
     void bind(unsigned int index, double value);
     void bind(unsigned int index, const value& value);
+    void bind_ref(unsigned int index, const std::string_view& value);
+    void bind_ref(unsigned int index, const blob_span& value);
 
     bool execute();
 
+    // Execute once for each row of column-wise parameter arrays, in a single bulk operation
+    bool supports_bulk() const;
+    bool execute_bulk(std::vector<MYSQL_BIND>& binds, unsigned int size);
+
+    // Transaction state and control of the statement's connection
+    bool in_transaction() const;
+    bool transaction_command(const std::string& command);
+
     bool has_row() const {
         return mysql_stmt_num_rows(_stmt.get()) != 0;
     }
 
-    unsigned long long row_count() const {
-        if (ok()) {
-            unsigned long long res = mysql_stmt_num_rows(_stmt.get());
-            if(res <= std::numeric_limits<unsigned int>::max()) {
-                return static_cast<unsigned int>(res);
-            }
-        }
-        // TODO log a warning ?
-        return std::numeric_limits<unsigned int>::max();
-    }
-
     void consume_results(std::function<void(const row_base&)> func);
 
 };
 
-void mysql_statement::store_all_results()
+//
+// MySql bind buffer row view
+//
+
+// Row view reading values of the last fetched row directly from the statement bind buffers
+class mysql_row : public row_base
 {
-    if (ok()) {
-        if(mysql_stmt_store_result(_stmt.get())!=0) {
-            int err = mysql_stmt_errno(_stmt.get());
-            const char* errstr = mysql_stmt_error(_stmt.get());
-            std::cout << "Error store results: " << err << " - " << errstr << std::endl;
-        }
+protected:
+    const mysql_statement& _stmt;
+
+public:
+    explicit mysql_row(const mysql_statement& stmt) : _stmt(stmt) {}
+
+    size_t size() const override;
+
+    value get_value(unsigned int index) const override;
+
+    std::string get_value_string(unsigned int index) const override;
+    blob get_value_blob(unsigned int index) const override;
+    bool get_value_bool(unsigned int index) const override;
+    int get_value_int(unsigned int index) const override;
+    int64_t get_value_int64(unsigned int index) const override;
+    double get_value_double(unsigned int index) const override;
+    std::string_view get_value_string_view(unsigned int index) const override;
+    blob_span get_value_blob_span(unsigned int index) const override;
+    bool is_null(unsigned int index) const override;
+    value_type get_value_type(unsigned int index) const override;
+    size_t value_size(unsigned int index) const override;
+};
+
+size_t mysql_row::size() const
+{
+    return _stmt.column_count();
+}
+
+value mysql_row::get_value(unsigned int index) const
+{
+    return _stmt.get_result(index);
+}
+
+std::string mysql_row::get_value_string(unsigned int index) const
+{
+    if(_stmt.result_type(index) == MYSQL_TYPE_STRING && !_stmt.is_null_result(index)) {
+        return std::string(_stmt.get_result_data(index));
     }
+    return to_string(_stmt.get_result(index));
+}
+
+blob mysql_row::get_value_blob(unsigned int index) const
+{
+    if((_stmt.result_type(index) == MYSQL_TYPE_STRING || _stmt.result_type(index) == MYSQL_TYPE_BLOB) && !_stmt.is_null_result(index)) {
+        std::string_view data = _stmt.get_result_data(index);
+        return blob(data.begin(), data.end());
+    }
+    return to_blob(_stmt.get_result(index));
+}
+
+bool mysql_row::get_value_bool(unsigned int index) const
+{
+    double number;
+    if(_stmt.get_result_number(index, number)) {
+        return number != 0;
+    }
+    return to_bool(_stmt.get_result(index));
+}
+
+int mysql_row::get_value_int(unsigned int index) const
+{
+    int number;
+    if(_stmt.get_result_number(index, number)) {
+        return number;
+    }
+    return to_int(_stmt.get_result(index));
+}
+
+int64_t mysql_row::get_value_int64(unsigned int index) const
+{
+    int64_t number;
+    if(_stmt.get_result_number(index, number)) {
+        return number;
+    }
+    return to_int64(_stmt.get_result(index));
+}
+
+double mysql_row::get_value_double(unsigned int index) const
+{
+    double number;
+    if(_stmt.get_result_number(index, number)) {
+        return number;
+    }
+    return to_double(_stmt.get_result(index));
+}
+
+std::string_view mysql_row::get_value_string_view(unsigned int index) const
+{
+    if((_stmt.result_type(index) == MYSQL_TYPE_STRING || _stmt.result_type(index) == MYSQL_TYPE_BLOB) && !_stmt.is_null_result(index)) {
+        return _stmt.get_result_data(index);
+    }
+    return {};
+}
+
+blob_span mysql_row::get_value_blob_span(unsigned int index) const
+{
+    std::string_view data = get_value_string_view(index);
+    return {reinterpret_cast<const unsigned char*>(data.data()), data.size()};
+}
+
+bool mysql_row::is_null(unsigned int index) const
+{
+    return _stmt.is_null_result(index);
+}
+
+value_type mysql_row::get_value_type(unsigned int index) const
+{
+    if (_stmt.is_null_result(index)) {
+        return value_type::NULL_VALUE;
+    }
+    return _stmt.column_type(index);
+}
+
+size_t mysql_row::value_size(unsigned int index) const
+{
+    if (_stmt.is_null_result(index)) {
+        return 0;
+    }
+    if (_stmt.result_type(index) == MYSQL_TYPE_STRING || _stmt.result_type(index) == MYSQL_TYPE_BLOB) {
+        return _stmt.get_result_length(index);
+    }
+    return sizeof(int64_t);
 }
 
 void mysql_statement::prepare_buffers()
 {
+    // Result metadata may change between executions
+    _column_names.clear();
+    _column_origin_names.clear();
+    _table_origin_names.clear();
+    _column_types.clear();
+    _lengths.clear();
+    _is_nulls.clear();
+    _my_types.clear();
+    _flags.clear();
+    _buffers.clear();
+    _binds.clear();
+
     if (ok()) {
         // Retrieve metadata for result columns
         MYSQL_RES* metadata = mysql_stmt_result_metadata(_stmt.get());
@@ -413,7 +532,7 @@ void mysql_statement::prepare_buffers()
                     break;
             }
             //        _types.push_back(field.type);
-            _lengths.push_back(std::max(field.length, field.max_length));
+            _lengths.push_back(std::min(field.length, initial_result_buffer_size));
             _flags.push_back(field.flags);
             _is_nulls.push_back(0);
         }
@@ -484,195 +603,227 @@ void mysql_statement::prepare_buffers()
 }
 
 
-std::vector<value> mysql_statement::fetch_next_row()
+bool mysql_statement::fetch()
 {
     if (ok()) {
         int res = mysql_stmt_fetch(_stmt.get());
         if(res!=0 && res!=MYSQL_NO_DATA && res!=MYSQL_DATA_TRUNCATED) {
             // TODO process error, throw exception
-            return {};
+            return false;
         } else if(res==MYSQL_NO_DATA) {
             // No data
-            return {};
-        } else {
-            std::vector<value> result;
-            result.reserve(_binds.size());
-            for(size_t i=0; i<_binds.size(); ++i) {
-                const MYSQL_BIND &bind = _binds[i];
-                if(bind.is_null!=nullptr && *bind.is_null != 0 || bind.is_null_value != 0) {
-                    result.emplace_back(nullptr);
-                } else {
-                    switch (bind.buffer_type) {
-                        case MYSQL_TYPE_TINY: {
-                            // TODO handle one-bit as boolean
-                            char val = *(char*)bind.buffer;
-                            if (_column_types[i]==value_type::BOOL) {
-                                result.emplace_back((bool)val!=0);
-                            } else {
-                                result.emplace_back((int)val);
-                            }
-                            break;
-                        }
-                        case MYSQL_TYPE_SHORT: {
-                            short val = *(short*)bind.buffer;
-                            result.emplace_back((int)val);
-                            break;
-                        }
-                        case MYSQL_TYPE_LONG:
-                        case MYSQL_TYPE_INT24:
-                        case MYSQL_TYPE_YEAR: {
-                            int val = *(int*)bind.buffer;
-                            result.emplace_back(val);
-                            break;
-                        }
-                        case MYSQL_TYPE_LONGLONG: {
-                            int64_t val = *(int64_t*)bind.buffer;
-                            result.emplace_back(val);
-                            break;
-                        }
-                        case MYSQL_TYPE_FLOAT:
-                            result.emplace_back((double)*(float*)bind.buffer);
-                            break;
-                        case MYSQL_TYPE_DOUBLE:
-                            result.emplace_back(*(double*)bind.buffer);
-                            break;
-                        case MYSQL_TYPE_STRING:
-                        case MYSQL_TYPE_VAR_STRING:
-                        case MYSQL_TYPE_VARCHAR:
-                        case MYSQL_TYPE_BLOB:
-                        case MYSQL_TYPE_TINY_BLOB:
-                        case MYSQL_TYPE_MEDIUM_BLOB:
-                        case MYSQL_TYPE_LONG_BLOB:
-                            // Always retrieve a BLOB for binary and text data without flags, look at the predeclared type
-                            if(_my_types[i]==MYSQL_TYPE_BLOB) {
-                                result.emplace_back(blob((const unsigned char *) bind.buffer,
-                                                         (const unsigned char *) bind.buffer + (size_t) *bind.length));
-                            } else {
-                                result.emplace_back(std::string((const char *) bind.buffer, (size_t)*bind.length));
-                            }
-                            break;
-                        case MYSQL_TYPE_NULL:
-                            result.emplace_back(nullptr);
-                            break;
-                        case MYSQL_TYPE_TIMESTAMP:
-                        case MYSQL_TYPE_DATE:
-                        case MYSQL_TYPE_TIME:
-                        case MYSQL_TYPE_DATETIME:
-                        case MYSQL_TYPE_NEWDATE:
-                        default:
-                            // Unsupported type
-                            result.emplace_back();
-                            break;
-                    }
-                }
+            return false;
+        }
+        if(res==MYSQL_DATA_TRUNCATED) {
+            return fetch_truncated();
+        }
+        return true;
+    }
+    return false;
+}
+
+bool mysql_statement::fetch_truncated()
+{
+    bool grown = false;
+    for(unsigned int i=0; i<_binds.size(); ++i) {
+        MYSQL_BIND &bind = _binds[i];
+        bool variable = _my_types[i]==MYSQL_TYPE_STRING || _my_types[i]==MYSQL_TYPE_BLOB;
+        if(!variable || is_null_result(i) || _lengths[i] <= _buffers[i].size()) {
+            continue;
+        }
+        // Keep the larger buffer for next rows, values of a column often have similar sizes
+        _buffers[i].resize(_lengths[i]);
+        bind.buffer = _buffers[i].data();
+        bind.buffer_length = _buffers[i].size();
+        if(mysql_stmt_fetch_column(_stmt.get(), &bind, i, 0)!=0) {
+            // TODO throw exception
+            std::cerr << "Failed to fetch truncated column: " << mysql_stmt_error(_stmt.get()) << std::endl;
+            return false;
+        }
+        grown = true;
+    }
+    // Buffers have moved, next fetches must use them
+    if(grown && mysql_stmt_bind_result(_stmt.get(), _binds.data())!=0) {
+        // TODO throw exception
+        std::cerr << "Failed to bind grown results: " << mysql_stmt_error(_stmt.get()) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool mysql_statement::is_null_result(unsigned int index) const
+{
+    const MYSQL_BIND &bind = _binds[index];
+    return bind.is_null!=nullptr && *bind.is_null != 0 || bind.is_null_value != 0;
+}
+
+std::string_view mysql_statement::get_result_data(unsigned int index) const
+{
+    const MYSQL_BIND &bind = _binds[index];
+    // Truncated values are only available up to the buffer size
+    size_t length = bind.length != nullptr ? std::min<size_t>(*bind.length, bind.buffer_length) : 0;
+    return {(const char *) bind.buffer, length};
+}
+
+unsigned long mysql_statement::get_result_length(unsigned int index) const
+{
+    const MYSQL_BIND &bind = _binds[index];
+    return bind.length != nullptr ? *bind.length : 0;
+}
+
+value mysql_statement::get_result(unsigned int index) const
+{
+    const MYSQL_BIND &bind = _binds[index];
+    if(is_null_result(index)) {
+        return nullptr;
+    }
+    switch (bind.buffer_type) {
+        case MYSQL_TYPE_TINY: {
+            // TODO handle one-bit as boolean
+            char val = *(char*)bind.buffer;
+            if (_column_types[index]==value_type::BOOL) {
+                return (bool)val!=0;
+            } else {
+                return (int)val;
             }
-            if(res==MYSQL_DATA_TRUNCATED) {
-                // TODO handle truncated data
+        }
+        case MYSQL_TYPE_SHORT:
+            return (int)*(short*)bind.buffer;
+        case MYSQL_TYPE_LONG:
+        case MYSQL_TYPE_INT24:
+        case MYSQL_TYPE_YEAR:
+            return *(int*)bind.buffer;
+        case MYSQL_TYPE_LONGLONG:
+            return *(int64_t*)bind.buffer;
+        case MYSQL_TYPE_FLOAT:
+            return (double)*(float*)bind.buffer;
+        case MYSQL_TYPE_DOUBLE:
+            return *(double*)bind.buffer;
+        case MYSQL_TYPE_STRING:
+        case MYSQL_TYPE_VAR_STRING:
+        case MYSQL_TYPE_VARCHAR:
+        case MYSQL_TYPE_BLOB:
+        case MYSQL_TYPE_TINY_BLOB:
+        case MYSQL_TYPE_MEDIUM_BLOB:
+        case MYSQL_TYPE_LONG_BLOB: {
+            // Always retrieve a BLOB for binary and text data without flags, look at the predeclared type
+            std::string_view data = get_result_data(index);
+            if(_my_types[index]==MYSQL_TYPE_BLOB) {
+                return blob(data.begin(), data.end());
+            } else {
+                return std::string(data);
             }
-            return result;
         }
+        case MYSQL_TYPE_NULL:
+            return nullptr;
+        case MYSQL_TYPE_TIMESTAMP:
+        case MYSQL_TYPE_DATE:
+        case MYSQL_TYPE_TIME:
+        case MYSQL_TYPE_DATETIME:
+        case MYSQL_TYPE_NEWDATE:
+        default:
+            // Unsupported type
+            return {};
     }
-    return {};
 }
 
 void mysql_statement::consume_results(std::function<void(const row_base&)> func)
 {
     prepare_buffers();
-    for (std::vector<value> row = fetch_next_row(); !row.empty(); row = fetch_next_row()) {
-        func(details::generic_row(row));
+    // Values are read directly from the bind buffers, nothing is copied for each row
+    mysql_row row(*this);
+    while (fetch()) {
+        func(row);
     }
 }
 
-std::vector<value> mysql_statement::fetch_row(unsigned long long index)
+value_type mysql_statement::column_type(unsigned int index) const
 {
-    if (ok()) {
-        mysql_stmt_data_seek(_stmt.get(), index);
-        return fetch_next_row();
-    } else {
-        return {};
+    return _column_types[index];
+}
+
+mysql_statement::param_slot& mysql_statement::param(unsigned int index, enum_field_types type, unsigned long length)
+{
+    if(_param_types.size() <= index) {
+        resize_params(index + 1);
     }
+    _param_lengths[index] = length;
+    _param_nulls[index] = type==MYSQL_TYPE_NULL ? 1 : 0;
+    _param_types[index] = type;
+    _param_slots[index].ref = nullptr;
+    return _param_slots[index];
 }
 
-value_type mysql_statement::column_type(unsigned int index) const
+void mysql_statement::resize_params(size_t count)
 {
-    return _column_types[index];
+    _param_lengths.resize(count, 0);
+    _param_nulls.resize(count, 1);
+    _param_types.resize(count, MYSQL_TYPE_NULL);
+    _param_slots.resize(count);
+}
+
+void* mysql_statement::param_buffer(unsigned int index)
+{
+    param_slot& slot = _param_slots[index];
+    switch(_param_types[index]) {
+        case MYSQL_TYPE_NULL:
+            return nullptr;
+        case MYSQL_TYPE_STRING:
+        case MYSQL_TYPE_BLOB:
+            return slot.ref!=nullptr ? const_cast<void*>(slot.ref) : slot.copy.data();
+        default:
+            return &slot.scalar;
+    }
 }
 
 void mysql_statement::bind(unsigned int index, std::nullptr_t)
 {
-    set<unsigned long>(_lengths, index, 0, 0);
-    set<my_bool>(_is_nulls, index, 1, 0);
-    set<enum_field_types>(_my_types, index, MYSQL_TYPE_NULL, MYSQL_TYPE_NULL);
-    set(_buffers, index, blob(), blob());
-    // TODO process error, throw exception
+    param(index, MYSQL_TYPE_NULL, 0);
 }
 
 void mysql_statement::bind(unsigned int index, const std::string& value)
 {
-    set<unsigned long>(_lengths, index, value.length(), 0);
-    set<my_bool>(_is_nulls, index, 0, 0);
-    set<enum_field_types>(_my_types, index, MYSQL_TYPE_STRING, MYSQL_TYPE_NULL);
-    set(_buffers, index, string_to_blob(value), blob());
-    // TODO process error, throw exception
+    bind(index, std::string_view(value));
 }
 
 void mysql_statement::bind(unsigned int index, const std::string_view& value)
 {
-    set<unsigned long>(_lengths, index, value.length(), 0);
-    set<my_bool>(_is_nulls, index, 0, 0);
-    set<enum_field_types>(_my_types, index, MYSQL_TYPE_STRING, MYSQL_TYPE_NULL);
-    set(_buffers, index, string_to_blob(value), blob());
-    // TODO process error, throw exception
+    param(index, MYSQL_TYPE_STRING, value.length()).copy.assign(value.begin(), value.end());
 }
 
 void mysql_statement::bind(unsigned int index, const blob& value)
 {
-    blob val;
-    set<unsigned long>(_lengths, index, value.size(), 0);
-    set<my_bool>(_is_nulls, index, 0, 0);
-    set<enum_field_types>(_my_types, index, MYSQL_TYPE_BLOB, MYSQL_TYPE_NULL);
-    set(_buffers, index, value, blob());
-    // TODO process error, throw exception
+    param(index, MYSQL_TYPE_BLOB, value.size()).copy.assign(value.begin(), value.end());
 }
 
 void mysql_statement::bind(unsigned int index, bool value)
 {
-    blob val;
-    set<unsigned long>(_lengths, index, 1, 0);
-    set<my_bool>(_is_nulls, index, 0, 0);
-    set<enum_field_types>(_my_types, index, MYSQL_TYPE_TINY, MYSQL_TYPE_NULL);
-    set(_buffers, index, num_to_blob((unsigned char)(value ? 1 : 0)), blob());
-    // TODO process error, throw exception
+    param(index, MYSQL_TYPE_TINY, 1).scalar.tiny = value ? 1 : 0;
 }
 
 void mysql_statement::bind(unsigned int index, int value)
 {
-    blob val;
-    set<unsigned long>(_lengths, index, sizeof(int), 0);
-    set<my_bool>(_is_nulls, index, 0, 0);
-    set<enum_field_types>(_my_types, index, MYSQL_TYPE_LONG, MYSQL_TYPE_NULL);
-    set(_buffers, index, num_to_blob(value), blob());
-    // TODO process error, throw exception
+    param(index, MYSQL_TYPE_LONG, sizeof(int)).scalar.int32 = value;
 }
 
 void mysql_statement::bind(unsigned int index, int64_t value)
 {
-    blob val;
-    set<unsigned long>(_lengths, index, sizeof(int64_t), 0);
-    set<my_bool>(_is_nulls, index, 0, 0);
-    set<enum_field_types>(_my_types, index, MYSQL_TYPE_LONGLONG, MYSQL_TYPE_NULL);
-    set(_buffers, index, num_to_blob(value), blob());
-    // TODO process error, throw exception
+    param(index, MYSQL_TYPE_LONGLONG, sizeof(int64_t)).scalar.int64 = value;
 }
 
 void mysql_statement::bind(unsigned int index, double value)
 {
-    blob val;
-    set<unsigned long>(_lengths, index, sizeof(double), 0);
-    set<my_bool>(_is_nulls, index, 0, 0);
-    set<enum_field_types>(_my_types, index, MYSQL_TYPE_DOUBLE, MYSQL_TYPE_NULL);
-    set(_buffers, index, num_to_blob(value), blob());
-    // TODO process error, throw exception
+    param(index, MYSQL_TYPE_DOUBLE, sizeof(double)).scalar.real = value;
+}
+
+void mysql_statement::bind_ref(unsigned int index, const std::string_view& value)
+{
+    param(index, MYSQL_TYPE_STRING, value.length()).ref = value.data();
+}
+
+void mysql_statement::bind_ref(unsigned int index, const blob_span& value)
+{
+    param(index, MYSQL_TYPE_BLOB, value.size()).ref = value.data();
 }
 
 void mysql_statement::bind(unsigned int index, const value& value)
@@ -683,26 +834,154 @@ void mysql_statement::bind(unsigned int index, const value& value)
 }
 
 
+bool mysql_statement::use_cursor(unsigned long prefetch_rows)
+{
+    unsigned long cursor_type = CURSOR_TYPE_READ_ONLY;
+    if (!ok()
+            || mysql_stmt_attr_set(_stmt.get(), STMT_ATTR_CURSOR_TYPE, &cursor_type) != 0
+            || mysql_stmt_attr_set(_stmt.get(), STMT_ATTR_PREFETCH_ROWS, &prefetch_rows) != 0) {
+        // TODO throw exception
+        std::cerr << "Failed to set statement cursor: " << mysql_stmt_error(_stmt.get()) << std::endl;
+        return false;
+    }
+    _cursor = true;
+    return true;
+}
+
+void mysql_statement::free_result()
+{
+    // Server-side cursors do not block the connection, they stay readable
+    if (ok() && _executed && !_cursor) {
+        mysql_stmt_free_result(_stmt.get());
+    }
+}
+
+void mysql_statement::reset()
+{
+    if (ok()) {
+        mysql_stmt_free_result(_stmt.get());
+        mysql_stmt_reset(_stmt.get());
+    }
+    _executed = false;
+    // Parameters are all NULL until bound again
+    std::fill(_param_lengths.begin(), _param_lengths.end(), 0);
+    std::fill(_param_nulls.begin(), _param_nulls.end(), 1);
+    std::fill(_param_types.begin(), _param_types.end(), MYSQL_TYPE_NULL);
+    for(auto& slot : _param_slots) {
+        slot.ref = nullptr;
+    }
+}
+
+void mysql_statement::release_pending()
+{
+    // Unfetched rows of the previous execution, or of another statement, would block the connection
+    if (_active) {
+        if (auto active = _active->lock(); active && active.get() != this) {
+            active->free_result();
+        }
+    }
+    if (_executed) {
+        mysql_stmt_free_result(_stmt.get());
+    }
+}
+
+void mysql_statement::set_executed()
+{
+    _executed = true;
+    if (_active) {
+        *_active = shared_from_this();
+    }
+}
+
+bool mysql_statement::supports_bulk() const
+{
+    if (!ok()) {
+        return false;
+    }
+    // Extended capabilities are the upper 32 bits of the MariaDB capability flags
+    unsigned long capabilities = 0;
+    mariadb_get_infov(_stmt->mysql, MARIADB_CONNECTION_EXTENDED_SERVER_CAPABILITIES, &capabilities);
+    return (capabilities & (MARIADB_CLIENT_STMT_BULK_OPERATIONS >> 32)) != 0;
+}
+
+bool mysql_statement::in_transaction() const
+{
+    if (!ok()) {
+        return false;
+    }
+    unsigned int status = 0;
+    mariadb_get_infov(_stmt->mysql, MARIADB_CONNECTION_SERVER_STATUS, &status);
+    return (status & SERVER_STATUS_IN_TRANS) != 0;
+}
+
+bool mysql_statement::transaction_command(const std::string& command)
+{
+    if (!ok()) {
+        return false;
+    }
+    release_pending();
+    if (mysql_real_query(_stmt->mysql, command.c_str(), command.length()) != 0) {
+        // TODO throw exception
+        std::cerr << "Failed to execute " << command << ": " << mysql_error(_stmt->mysql) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool mysql_statement::execute_bulk(std::vector<MYSQL_BIND>& binds, unsigned int size)
+{
+    if (!ok()) {
+        return false;
+    }
+    release_pending();
+
+    bool res = mysql_stmt_attr_set(_stmt.get(), STMT_ATTR_ARRAY_SIZE, &size) == 0
+            && mysql_stmt_bind_param(_stmt.get(), binds.data()) == 0
+            && mysql_stmt_execute(_stmt.get()) == 0;
+    if (!res) {
+        // TODO throw exception
+        std::cerr << "Failed to execute bulk statement: " << mysql_stmt_error(_stmt.get()) << std::endl;
+    }
+
+    // Back to single row executions, scalar parameters are bound again on next execution
+    unsigned int no_array = 0;
+    mysql_stmt_attr_set(_stmt.get(), STMT_ATTR_ARRAY_SIZE, &no_array);
+
+    if (res) {
+        set_executed();
+    }
+    return res;
+}
+
 bool mysql_statement::execute()
 {
     if (!ok()) {
         return false;
     }
+    release_pending();
 
-    // Bind parameters, if any
-    if(!_my_types.empty()) {
-        std::vector<MYSQL_BIND> binds;
-        binds.resize(_my_types.size(), bind0);
+    // Parameters not bound yet are NULL
+    unsigned int count = parameter_count();
+    if (_param_types.size() < count) {
+        resize_params(count);
+    }
 
-        for(size_t idx = 0; idx<_my_types.size(); idx++) {
-            binds[idx].buffer_type = _my_types[idx];
-            binds[idx].buffer_length = _lengths[idx];
-            binds[idx].buffer = _buffers[idx].data();
-            binds[idx].length = &_lengths[idx];
-            binds[idx].is_null = (my_bool * ) & _is_nulls[idx];
+    // Bind parameters, if any. Binds are reused, only their fields are updated.
+    if(!_param_types.empty()) {
+        if(_param_binds.size() != _param_types.size()) {
+            _param_binds.assign(_param_types.size(), bind0);
         }
 
-        if (mysql_stmt_bind_param(_stmt.get(), binds.data()) != 0) { // skip index 0
+        for(size_t idx = 0; idx<_param_types.size(); idx++) {
+            MYSQL_BIND& bind = _param_binds[idx];
+            bind.buffer_type = _param_types[idx];
+            bind.buffer_length = _param_lengths[idx];
+            bind.buffer = param_buffer(idx);
+            bind.length = &_param_lengths[idx];
+            bind.is_null = &_param_nulls[idx];
+        }
+
+        if (mysql_stmt_bind_param(_stmt.get(), _param_binds.data()) != 0) {
             // TODO throw exception
             // throw statement_exception(mysql_stmt_error(_stmt.get()), mysql_stmt_errno(_stmt.get()));
             int err = mysql_stmt_errno(_stmt.get());
@@ -718,6 +997,7 @@ bool mysql_statement::execute()
         return false;
     }
 
+    set_executed();
     return true;
 }
 
@@ -745,11 +1025,11 @@ public:
 
     bool has_row() const override;
 
-    std::vector<value> fetch_next_row() {return _stmt->fetch_next_row();}
-
     sqlcpp::resultset_row_iterator begin() const override;
     sqlcpp::resultset_row_iterator end() const override;
 
+    size_t fetch_batch(span<const batch_column> columns) override;
+
 protected:
     friend class resultset_row_iterator_impl;
 
@@ -760,102 +1040,140 @@ private:
 };
 
 // Late implementation to have all required declarations
+resultset_row_iterator_impl::resultset_row_iterator_impl(std::shared_ptr<resultset> resultset) :
+_resultset(std::move(resultset))
+{
+    fetch_next_row();
+}
+
 void resultset_row_iterator_impl::fetch_next_row() {
-    if(_resultset) {
-        _current_row = _resultset->fetch_next_row();
-        if(_current_row.empty()) {
-            _resultset = nullptr;
-        }
-    } else {
-        _current_row.clear();
+    if(_resultset && !_resultset->_stmt->fetch()) {
+        _resultset = nullptr;
     }
 }
 
+size_t resultset::fetch_batch(span<const batch_column> columns)
+{
+    size_t capacity = batch_column::capacity(columns);
+    size_t count = 0;
+    size_t values = 0;
+    for (; count < capacity && _stmt->fetch(); ++count) {
+        for (const auto& column : columns) {
+            int64_t int_value;
+            double double_value;
+            values += !_stmt->is_null_result(column.index());
+            // Numbers are read from their bind buffer, other results through the row getters
+            if (column.type() == value_type::INT64 && _stmt->get_result_number(column.index(), int_value)) {
+                column.set(count, int_value);
+            } else if (column.type() == value_type::DOUBLE && _stmt->get_result_number(column.index(), double_value)) {
+                column.set(count, double_value);
+            } else {
+                column.set(count, mysql_row(*_stmt));
+            }
+        }
+    }
+    if (_observation) {
+        _observation->fetched(count, values * sizeof(int64_t));
+    }
+    return count;
+}
 
-bool resultset::has_row() const
+mysql_row resultset_row_iterator_impl::current_row() const
 {
-    return _stmt->has_row();
+    return mysql_row(*_resultset->_stmt);
 }
 
-sqlcpp::resultset_row_iterator resultset::begin() const
+const row_base& resultset_row_iterator_impl::get() const
 {
-    std::shared_ptr<resultset> self = const_cast<resultset*>(this)->shared_from_this();
-    return std::move(sqlcpp::cursor_resultset::create_iterator(std::make_shared<resultset_row_iterator_impl>(self)));
+    return *this;
 }
 
-sqlcpp::resultset_row_iterator resultset::end() const
+bool resultset_row_iterator_impl::next()
 {
-    return std::move(sqlcpp::cursor_resultset::create_iterator(std::make_shared<resultset_row_iterator_impl>(nullptr)));
+    fetch_next_row();
+    return _resultset == nullptr;
 }
 
-//
-// Buffered resultset
-//
-
-class buffered_resultset : public sqlcpp::buffered_resultset, public std::enable_shared_from_this<buffered_resultset>
+bool resultset_row_iterator_impl::different(const sqlcpp::resultset_row_iterator_impl& other) const
 {
-public:
-    buffered_resultset(std::shared_ptr<mysql_statement> stmt) : _stmt(stmt) {
-        _stmt->store_all_results();
-        _stmt->prepare_buffers();
+    if(auto impl = dynamic_cast<const resultset_row_iterator_impl*>(&other) ; impl!=nullptr) {
+        return _resultset != impl->_resultset;
+    } else {
+        return true;
     }
-    ~buffered_resultset() override =default;
-
-    unsigned long long affected_rows() const override {return _stmt->affected_rows();}
-    unsigned long long last_insert_id() const override {return _stmt->last_insert_id();}
+}
 
-    unsigned int column_count() const override {return _stmt->column_count();}
-    std::string column_name(unsigned int index) const override {return _stmt->column_name(index);}
-    unsigned int column_index(const std::string& name) const override {return _stmt->column_index(name);}
-    std::string column_origin_name(unsigned int index) const override {return _stmt->column_origin_name(index);}
-    std::string table_origin_name(unsigned int index) const override {return _stmt->table_origin_name(index);}
-    value_type column_type(unsigned int index) const override {return _stmt->column_type(index);}
+size_t resultset_row_iterator_impl::size() const
+{
+    return _resultset ? _resultset->column_count() : 0;
+}
 
-    unsigned int row_count() const /*override*/;
-    bool has_row() const override;
+value resultset_row_iterator_impl::get_value(unsigned int index) const
+{
+    return _resultset ? current_row().get_value(index) : value{};
+}
 
-    iterator begin() const override;
+std::string resultset_row_iterator_impl::get_value_string(unsigned int index) const
+{
+    return _resultset ? current_row().get_value_string(index) : std::string{};
+}
 
-    iterator end() const override;
+blob resultset_row_iterator_impl::get_value_blob(unsigned int index) const
+{
+    return _resultset ? current_row().get_value_blob(index) : blob{};
+}
 
-    const row_base & get_row(unsigned long long index) const override;
+bool resultset_row_iterator_impl::get_value_bool(unsigned int index) const
+{
+    return _resultset ? current_row().get_value_bool(index) : false;
+}
 
-protected:
-    friend class resultset_row_iterator_impl;
+int resultset_row_iterator_impl::get_value_int(unsigned int index) const
+{
+    return _resultset ? current_row().get_value_int(index) : 0;
+}
 
-    std::shared_ptr<mysql_statement> _stmt;
-    mutable details::generic_row _current_row;
+int64_t resultset_row_iterator_impl::get_value_int64(unsigned int index) const
+{
+    return _resultset ? current_row().get_value_int64(index) : 0;
+}
 
-};
+double resultset_row_iterator_impl::get_value_double(unsigned int index) const
+{
+    return _resultset ? current_row().get_value_double(index) : 0;
+}
 
-unsigned int buffered_resultset::row_count() const
+std::string_view resultset_row_iterator_impl::get_value_string_view(unsigned int index) const
 {
-    return _stmt->row_count();
+    return _resultset ? current_row().get_value_string_view(index) : std::string_view{};
 }
 
-buffered_resultset::iterator buffered_resultset::begin() const
+blob_span resultset_row_iterator_impl::get_value_blob_span(unsigned int index) const
 {
-    // TODO
-    return {};
+    return _resultset ? current_row().get_value_blob_span(index) : blob_span{};
 }
 
-buffered_resultset::iterator buffered_resultset::end() const
+bool resultset_row_iterator_impl::is_null(unsigned int index) const
 {
-    // TODO
-    return {};
+    return !_resultset || current_row().is_null(index);
 }
 
-bool buffered_resultset::has_row() const
+
+bool resultset::has_row() const
 {
     return _stmt->has_row();
 }
 
-const row_base & buffered_resultset::get_row(unsigned long long index) const
+sqlcpp::resultset_row_iterator resultset::begin() const
 {
-    _current_row.set_values(_stmt->fetch_row(index));
-    return _current_row;
+    std::shared_ptr<resultset> self = const_cast<resultset*>(this)->shared_from_this();
+    return std::move(sqlcpp::cursor_resultset::create_iterator(std::make_shared<resultset_row_iterator_impl>(self)));
 }
 
+sqlcpp::resultset_row_iterator resultset::end() const
+{
+    return std::move(sqlcpp::cursor_resultset::create_iterator(std::make_shared<resultset_row_iterator_impl>(nullptr)));
+}
 
 //
 // Statement
@@ -888,6 +1206,10 @@ public:
     std::shared_ptr<sqlcpp::cursor_resultset> execute() override;
     void execute(std::function<void(const row_base&)> func) override;
     std::shared_ptr<sqlcpp::buffered_resultset> execute_buffered() override;
+    std::shared_ptr<sqlcpp::columnar_resultset> execute_columnar() override;
+    std::shared_ptr<stats_result> execute_array() override;
+
+    void reset() override;
 
     unsigned int parameter_count() const override;
     int parameter_index(const std::string& name) const override;
@@ -913,8 +1235,116 @@ public:
     statement& bind(unsigned int index, double value) override;
     statement& bind(unsigned int index, const value& value) override;
 
+    statement& bind_ref(unsigned int index, const std::string_view& value) override;
+    statement& bind_ref(unsigned int index, const blob_span& value) override;
 };
 
+std::shared_ptr<stats_result> statement::execute_array()
+{
+    std::optional<size_t> rows = array_size();
+    if (!rows) {
+        // TODO throw exception
+        return {};
+    }
+    // Bulk execution needs all parameters bound to arrays and server support (MariaDB 10.2+)
+    unsigned int count = _stmt->parameter_count();
+    if (*rows == 0 || *rows > std::numeric_limits<unsigned int>::max() || _array_params.size() != count || !_stmt->supports_bulk()) {
+        // Rows are executed one by one, in one transaction unless one is already open
+        bool transaction = !_stmt->in_transaction();
+        if (transaction && !_stmt->transaction_command("START TRANSACTION")) {
+            return {};
+        }
+        std::shared_ptr<stats_result> res = sqlcpp::statement::execute_array();
+        if (transaction && !_stmt->transaction_command(res ? "COMMIT" : "ROLLBACK")) {
+            return {};
+        }
+        return res;
+    }
+    std::shared_ptr<details::query_observation> observation = observe();
+
+    // Column-wise binding: fixed size values are read from the arrays directly,
+    // variable size values through arrays of pointers and lengths
+    static_assert(sizeof(bool) == 1, "bool arrays are sent as TINYINT");
+    std::vector<MYSQL_BIND> binds(count, bind0);
+    std::vector<std::vector<char>> indicators(count);
+    std::vector<std::vector<const char*>> pointers(count);
+    std::vector<std::vector<unsigned long>> lengths(count);
+    for (const auto& param : _array_params) {
+        if (param.index < 1 || param.index > count) {
+            std::cerr << "Invalid parameter index " << param.index << std::endl;
+            // TODO throw exception
+            return {};
+        }
+        size_t slot = param.index - 1;
+        MYSQL_BIND& bind = binds[slot];
+        if (!param.nulls.empty()) {
+            indicators[slot].resize(*rows);
+            for (size_t row = 0; row < *rows; ++row) {
+                indicators[slot][row] = param.is_null(row) ? STMT_INDICATOR_NULL : STMT_INDICATOR_NONE;
+            }
+            bind.u.indicator = indicators[slot].data();
+        }
+
+        auto bind_views = [&](enum_field_types type, auto get) {
+            pointers[slot].resize(*rows);
+            lengths[slot].resize(*rows);
+            for (size_t row = 0; row < *rows; ++row) {
+                std::string_view data = get(row);
+                pointers[slot][row] = data.data();
+                lengths[slot][row] = data.size();
+            }
+            bind.buffer_type = type;
+            bind.buffer = pointers[slot].data();
+            bind.length = lengths[slot].data();
+        };
+
+        switch (param.type) {
+            case array_param::BOOL:
+                bind.buffer_type = MYSQL_TYPE_TINY;
+                bind.buffer = const_cast<void*>(param.data);
+                break;
+            case array_param::INT:
+                bind.buffer_type = MYSQL_TYPE_LONG;
+                bind.buffer = const_cast<void*>(param.data);
+                break;
+            case array_param::INT64:
+                bind.buffer_type = MYSQL_TYPE_LONGLONG;
+                bind.buffer = const_cast<void*>(param.data);
+                break;
+            case array_param::DOUBLE:
+                bind.buffer_type = MYSQL_TYPE_DOUBLE;
+                bind.buffer = const_cast<void*>(param.data);
+                break;
+            case array_param::STRING:
+                bind_views(MYSQL_TYPE_STRING, [&](size_t row) { return std::string_view(param.get<std::string>(row)); });
+                break;
+            case array_param::STRING_VIEW:
+                bind_views(MYSQL_TYPE_STRING, [&](size_t row) { return param.get<std::string_view>(row); });
+                break;
+            case array_param::BLOB:
+                bind_views(MYSQL_TYPE_BLOB, [&](size_t row) {
+                    const blob& data = param.get<blob>(row);
+                    return std::string_view(reinterpret_cast<const char*>(data.data()), data.size());
+                });
+                break;
+        }
+    }
+
+    if (!_stmt->execute_bulk(binds, *rows)) {
+        return {};
+    }
+    if (observation) {
+        observation->executed(false);
+    }
+    return std::make_shared<details::simple_stats_result>(_stmt->affected_rows(), _stmt->last_insert_id());
+}
+
+void statement::reset()
+{
+    sqlcpp::statement::reset();
+    _stmt->reset();
+}
+
 unsigned int statement::parameter_count() const {
     return _stmt->parameter_count();
 }
@@ -1017,6 +1447,18 @@ statement& statement::bind(unsigned int index, const std::string_view& value)
     return *this;
 }
 
+statement& statement::bind_ref(unsigned int index, const std::string_view& value)
+{
+    _stmt->bind_ref(index-1, value);
+    return *this;
+}
+
+statement& statement::bind_ref(unsigned int index, const blob_span& value)
+{
+    _stmt->bind_ref(index-1, value);
+    return *this;
+}
+
 statement& statement::bind(unsigned int index, const blob& value)
 {
     _stmt->bind(index-1, value);
@@ -1056,8 +1498,14 @@ statement& statement::bind(unsigned int index, const value& value)
 
 std::shared_ptr<sqlcpp::cursor_resultset> statement::execute()
 {
+    std::shared_ptr<details::query_observation> observation = observe();
     if (_stmt->execute()) {
-        return std::make_shared<resultset>(_stmt);
+        auto rset = std::make_shared<resultset>(_stmt);
+        if (observation) {
+            observation->executed();
+            rset->observe(std::move(observation));
+        }
+        return rset;
     } else {
         return nullptr;
     }
@@ -1065,18 +1513,72 @@ std::shared_ptr<sqlcpp::cursor_resultset> statement::execute()
 
 void statement::execute(std::function<void(const row_base&)> func)
 {
+    std::shared_ptr<details::query_observation> observation = observe();
     if (_stmt->execute()) {
-        _stmt->consume_results(func);
+        if (observation) {
+            observation->executed();
+            _stmt->consume_results([&](const row_base& row) {
+                observation->fetched(row);
+                func(row);
+            });
+        } else {
+            _stmt->consume_results(func);
+        }
     }
 }
 
 std::shared_ptr<sqlcpp::buffered_resultset> statement::execute_buffered()
 {
-    if (_stmt->execute()) {
-        return std::make_shared<buffered_resultset>(_stmt);
-    } else {
+    std::shared_ptr<details::query_observation> observation = observe();
+    if (!_stmt->execute()) {
         return nullptr;
     }
+    if (observation) {
+        observation->executed();
+    }
+    auto res = std::make_shared<details::generic_buffered_resultset>();
+    _stmt->prepare_buffers();
+    for (unsigned int index = 0; index < _stmt->column_count(); ++index) {
+        res->add_column(_stmt->column_name(index), _stmt->column_type(index), _stmt->column_origin_name(index), _stmt->table_origin_name(index));
+    }
+    // Rows are decoded once from the bind buffers, then iterated and accessed without the statement
+    mysql_row row(*_stmt);
+    while (_stmt->fetch()) {
+        res->add_row(row);
+    }
+    res->affected_rows(_stmt->affected_rows());
+    res->last_insert_id(_stmt->last_insert_id());
+    if (observation) {
+        observation->fetched(*res);
+    }
+    return res;
+}
+
+std::shared_ptr<sqlcpp::columnar_resultset> statement::execute_columnar()
+{
+    std::shared_ptr<details::query_observation> observation = observe();
+    if (!_stmt->execute()) {
+        return nullptr;
+    }
+    if (observation) {
+        observation->executed();
+    }
+    auto res = std::make_shared<details::columnar_buffered_resultset>();
+    _stmt->prepare_buffers();
+    for (unsigned int index = 0; index < _stmt->column_count(); ++index) {
+        res->add_column(_stmt->column_name(index), _stmt->column_type(index), _stmt->column_origin_name(index), _stmt->table_origin_name(index));
+    }
+    // Values are copied directly from the bind buffers
+    mysql_row row(*_stmt);
+    while (_stmt->fetch()) {
+        if (observation) {
+            observation->fetched(row);
+        }
+        res->add_row(row);
+    }
+    res->affected_rows(_stmt->affected_rows());
+    res->last_insert_id(_stmt->last_insert_id());
+    return res;
 }
 
 
@@ -1087,13 +1589,20 @@ std::shared_ptr<sqlcpp::buffered_resultset> statement::execute_buffered()
 //
 
 connection::connection(MYSQL* db):
-    _db(db, &mysql_close)
+    _db(db, &mysql_close),
+    _active_stmt(std::make_shared<std::weak_ptr<mysql_statement>>())
 {
     if(db== nullptr) {
         // TODO throw an exception
     }
 }
 
+connection::~connection()
+{
+    // Cached statements must be closed before the connection
+    clear_statement_cache();
+}
+
 std::shared_ptr<connection> connection::create(const std::string& connection_string) {
     if(bind0.buffer_length!=0) {// init only once
         memset(&bind0, 0, sizeof(MYSQL_BIND));
@@ -1144,27 +1653,13 @@ std::shared_ptr<connection> connection::create(const std::string& host,
 }
 
 std::shared_ptr<sqlcpp::statement> connection::prepare(const std::string& sql) {
+    std::shared_ptr<details::query_observation> observation = observe(sql);
     if(sql.empty()) {
         // TODO throw connection_exception("SQL query is empty");
     }
 
-    if (_last_stmt) {
-        _last_stmt->close();
-        _last_stmt.reset();
-    }
-
     MYSQL_STMT* stmt = mysql_stmt_init(_db.get());
 
-    // Force update of max_length on result set metadata fetch
-    static const my_bool update_max_length = 1;
-    if(mysql_stmt_attr_set(stmt, STMT_ATTR_UPDATE_MAX_LENGTH, (void *)&update_max_length)) {
-        // TODO throw an exception with mysql_error(mysql)
-        int err = mysql_errno(_db.get());
-        const char* errstr = mysql_error(_db.get());
-        mysql_stmt_close(stmt);
-        return nullptr;
-    }
-
     if(mysql_stmt_prepare(stmt, sql.c_str(), sql.length())) {
         // TODO throw an exception with mysql_error(mysql)
         // diag("Error: %s (%s: %d)", mysql_stmt_error(stmt), __FILE__, __LINE__);
@@ -1174,17 +1669,24 @@ std::shared_ptr<sqlcpp::statement> connection::prepare(const std::string& sql) {
         return nullptr;
     }
 
-    auto mdb_stmt = std::make_shared<mysql_statement>(stmt);
-    _last_stmt = mdb_stmt;
+    auto mdb_stmt = std::make_shared<mysql_statement>(stmt, _active_stmt);
+    if (_cursor_prefetch_rows > 0 && !mdb_stmt->use_cursor(_cursor_prefetch_rows)) {
+        return nullptr;
+    }
 
-    return std::make_shared<statement>(mdb_stmt);
+    auto mdb = std::make_shared<statement>(mdb_stmt);
+    if (observation) {
+        observation->prepared(*mdb);
+    }
+    return mdb;
 }
 
 std::shared_ptr<stats_result> connection::execute(const std::string& sql) {
+    std::shared_ptr<details::query_observation> observation = observe(sql);
 
-    if (_last_stmt) {
-        _last_stmt->close();
-        _last_stmt.reset();
+    // Unfetched rows of the last executed statement would block the connection
+    if (auto active = _active_stmt->lock()) {
+        active->free_result();
     }
 
     if (mysql_real_query(_db.get(), sql.c_str(), sql.length()) != 0) {
@@ -1221,9 +1723,31 @@ std::shared_ptr<stats_result> connection::execute(const std::string& sql) {
             real_last_inserted_id = last_inserted_id;
         }
     } while(mysql_next_result(_db.get())==0);
+    if (observation) {
+        observation->executed(false);
+    }
     return std::make_shared<details::simple_stats_result>(total_affected_rows, real_last_inserted_id);
 }
 
+bool connection::is_valid()
+{
+    return _db && mysql_ping(_db.get()) == 0;
+}
+
+unsigned long connection::cursor_prefetch_rows() const
+{
+    return _cursor_prefetch_rows;
+}
+
+void connection::cursor_prefetch_rows(unsigned long rows)
+{
+    // Cached statements keep the cursor they were prepared with
+    if (rows != _cursor_prefetch_rows) {
+        clear_statement_cache();
+    }
+    _cursor_prefetch_rows = rows;
+}
+
 
 
 //
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2024-2025 Emilien Kia <emilien.kia+dev@gmail.com>
+ *
+ * sqlcpp is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlcpp is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.";
+ */
+
+#include "../include/sqlcpp/pool.hpp"
+
+#include <iostream>
+
+namespace sqlcpp
+{
+
+//
+// Connection pool lease
+//
+
+connection_pool::lease::lease(std::shared_ptr<connection_pool> pool, std::shared_ptr<connection> conn) :
+    _pool(std::move(pool)),
+    _connection(std::move(conn))
+{
+}
+
+connection_pool::lease::~lease()
+{
+    release();
+}
+
+connection_pool::lease& connection_pool::lease::operator=(lease&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        _pool = std::move(other._pool);
+        _connection = std::move(other._connection);
+    }
+    return *this;
+}
+
+void connection_pool::lease::release()
+{
+    if (_pool && _connection) {
+        _pool->give_back(std::move(_connection), true);
+    }
+    _connection.reset();
+    _pool.reset();
+}
+
+void connection_pool::lease::invalidate()
+{
+    if (_pool && _connection) {
+        _pool->give_back(std::move(_connection), false);
+    }
+    _connection.reset();
+    _pool.reset();
+}
+
+//
+// Connection pool
+//
+
+connection_pool::connection_pool(factory_t factory, const connection_pool_options& options) :
+    _factory(std::move(factory)),
+    _options(options)
+{
+    if (_options.max_size == 0) {
+        _options.max_size = 1;
+    }
+    if (_options.min_size > _options.max_size) {
+        _options.min_size = _options.max_size;
+    }
+}
+
+std::shared_ptr<connection_pool> connection_pool::create(const std::string& connection_string, const connection_pool_options& options)
+{
+    return create([connection_string]() {
+        return connection::create(connection_string);
+    }, options);
+}
+
+std::shared_ptr<connection_pool> connection_pool::create(factory_t factory, const connection_pool_options& options)
+{
+    auto pool = std::make_shared<connection_pool>(std::move(factory), options);
+    auto now = clock::now();
+    for (size_t index = 0; index < pool->_options.min_size; ++index) {
+        std::shared_ptr<connection> conn;
+        try {
+            conn = pool->_factory();
+        } catch (...) {
+            // Missing connections are opened on demand by acquire()
+            std::cerr << "Failed to open pooled connection" << std::endl;
+            break;
+        }
+        if (!conn) {
+            std::cerr << "Failed to open pooled connection" << std::endl;
+            break;
+        }
+        pool->_idle.push_back({std::move(conn), now});
+        ++pool->_size;
+    }
+    return pool;
+}
+
+connection_pool::lease connection_pool::acquire()
+{
+    return acquire(_options.checkout_timeout);
+}
+
+connection_pool::lease connection_pool::try_acquire()
+{
+    return acquire(std::chrono::milliseconds::zero());
+}
+
+connection_pool::lease connection_pool::acquire(std::chrono::milliseconds timeout)
+{
+    auto deadline = clock::now() + timeout;
+    // Expired connections are closed after the lock is released
+    std::vector<std::shared_ptr<connection>> expired;
+    std::unique_lock<std::mutex> lock(_mutex);
+    expired = take_expired(clock::now());
+
+    while (true) {
+        if (!_idle.empty()) {
+            idle_connection idle = std::move(_idle.back());
+            _idle.pop_back();
+            if (clock::now() - idle.since < _options.validation_interval) {
+                return {shared_from_this(), std::move(idle.conn)};
+            }
+            // Lazy validation, without holding the lock
+            lock.unlock();
+            if (idle.conn->is_valid()) {
+                return {shared_from_this(), std::move(idle.conn)};
+            }
+            idle.conn.reset();
+            lock.lock();
+            --_size;
+            continue;
+        }
+
+        if (_size < _options.max_size) {
+            // Reserve the slot then open the connection without holding the lock
+            ++_size;
+            lock.unlock();
+            std::shared_ptr<connection> conn;
+            try {
+                conn = _factory();
+            } catch (...) {
+                // Release the reserved slot, then let the caller handle the failure
+                lock.lock();
+                --_size;
+                _available.notify_one();
+                throw;
+            }
+            if (conn) {
+                return {shared_from_this(), std::move(conn)};
+            }
+            std::cerr << "Failed to open pooled connection" << std::endl;
+            lock.lock();
+            --_size;
+            _available.notify_one();
+            // TODO throw exception
+            return {};
+        }
+
+        if (!_available.wait_until(lock, deadline, [this]() { return !_idle.empty() || _size < _options.max_size; })) {
+            // TODO throw exception
+            return {};
+        }
+    }
+}
+
+void connection_pool::give_back(std::shared_ptr<connection> conn, bool valid)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (valid) {
+            _idle.push_back({std::move(conn), clock::now()});
+        } else {
+            --_size;
+        }
+    }
+    _available.notify_one();
+    // Invalid connection, if any, is closed here without holding the lock
+}
+
+std::vector<std::shared_ptr<connection>> connection_pool::take_expired(clock::time_point now)
+{
+    std::vector<std::shared_ptr<connection>> expired;
+    if (_options.idle_timeout.count() == 0) {
+        return expired;
+    }
+    // Least recently used connections are at the front
+    while (!_idle.empty() && _size > _options.min_size && now - _idle.front().since >= _options.idle_timeout) {
+        expired.push_back(std::move(_idle.front().conn));
+        _idle.pop_front();
+        --_size;
+    }
+    return expired;
+}
+
+void connection_pool::evict_idle()
+{
+    std::vector<std::shared_ptr<connection>> expired;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        expired = take_expired(clock::now());
+    }
+    if (!expired.empty()) {
+        _available.notify_all();
+    }
+}
+
+size_t connection_pool::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _size;
+}
+
+size_t connection_pool::idle_count() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _idle.size();
+}
+
+} // namespace sqlcpp
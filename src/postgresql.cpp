@@ -20,6 +20,8 @@
 
 #include <postgresql/16/server/catalog/pg_type_d.h>
 
+#include <cstdio>
+#include <cstring>
 #include <string>
 #include <iostream>
 #include <limits>
@@ -37,9 +39,33 @@
  * Implementation notes:
  * Postgres' methods PQcmdTuples(...) and PQoidValue(...) are really restrictive, and may return low or underestimated results.
  *
+ * Results can be retrieved in binary format (see connection::binary_results(bool)).
+ * Binary values are in network byte order and are decoded directly for BOOL, INT2/4/8, FLOAT4/8, text types and BYTEA.
+ * As libpq applies the same format to all the result columns, statements returning any other column type are
+ * described once at preparation and fall back to text format.
+ *
+ * Parameters can be sent in binary format (see connection::binary_parameters(bool)).
+ * Expected parameter types are described once per statement, and values matching them are sent in their binary
+ * representation (BOOL, INT2/4/8, FLOAT4/8 and BYTEA), other ones fall back to text format.
+ *
+ * Cursor and callback executions can stream rows (see connection::streaming_rows(unsigned int)).
+ * Queries are then sent with PQsendQueryPrepared() and rows are received in single-row mode, or by chunks with libpq 17+.
+ * The connection stays busy until all rows are consumed or the resultset is destroyed (the query is then cancelled).
+ *
+ * Statement executions can be queued in a pipeline (libpq 14+), results are collected at synchronization points.
+ * Without pipelining support in libpq, queued statements are executed immediately.
+ *
+ * Bulk loads use COPY ... FROM STDIN (see connection::copy_from(...)). Column types are retrieved first with an empty
+ * SELECT to choose between binary and text COPY formats and to encode values accordingly.
+ * Exports use COPY (...) TO STDOUT (see connection::copy_to(...)), the query is described first for the same reasons.
+ * Each row received with PQgetCopyData() is decoded in place and exposed through a row_base view, without PGresult.
+ *
+ * String views are direct for text types. BYTEA views are direct in binary format, text format values are decoded into
+ * per-column buffers of the row view, reused from row to row.
+ * Text format BYTEA values (hex or escape format) and hex encoded parameters use the vectorized codecs of codec.cpp.
+ *
  * TODO:
  * - Implement generic bind by name
- * - Implement binary format
  */
 
 
@@ -54,67 +80,69 @@ class helpers
 {
     helpers() = delete;
 public:
+    // Text bytea decoders, in hex or escape format
+    static bool parse_blob(const std::string_view& str, blob& res);
     static blob parse_blob(const std::string_view& str);
     static value_type column_type_from_oid(Oid oid);
     static value get_value(PGresult* res, unsigned int row, unsigned int col);
+    static value get_value(Oid oid, bool binary, const char* val, int size);
+
+    static std::shared_ptr<stats_result> get_stats(PGresult* res);
+    static bool is_partial_result(ExecStatusType type);
+    static void drain_results(PGconn* db);
+    static void cancel_query(PGconn* db);
+
+    // Typed cell accessors, cell must not be null
+    static std::string get_string(PGresult* res, unsigned int row, unsigned int col);
+    static blob get_blob(PGresult* res, unsigned int row, unsigned int col);
+    static bool get_bool(PGresult* res, unsigned int row, unsigned int col);
+    static int64_t get_int64(PGresult* res, unsigned int row, unsigned int col);
+    static double get_double(PGresult* res, unsigned int row, unsigned int col);
+
+    // Typed value decoders, text values must be null-terminated
+    static std::string get_string(Oid oid, bool binary, const char* val, int size);
+    static blob get_blob(Oid oid, bool binary, const char* val, int size);
+    static bool get_bool(Oid oid, bool binary, const char* val, int size);
+    static int64_t get_int64(Oid oid, bool binary, const char* val, int size);
+    static double get_double(Oid oid, bool binary, const char* val, int size);
+    // View of text and BYTEA values, text BYTEA values are decoded into buffer
+    static std::string_view get_view(Oid oid, bool binary, const char* val, int size, blob& buffer);
+    // Received size of a non-NULL value, see row_base::value_size()
+    static size_t value_size(Oid oid, int size);
+
+    // Binary format decoders, values are in network byte order
+    static int16_t read_int16(const char* val);
+    static int32_t read_int32(const char* val);
+    static int64_t read_int64(const char* val);
+    static float read_float4(const char* val);
+    static double read_float8(const char* val);
+
+    // Binary format encoders, values are written in network byte order
+    static void write_int16(char* buffer, int16_t val);
+    static void write_int32(char* buffer, int32_t val);
+    static void write_int64(char* buffer, int64_t val);
+    static void write_float4(char* buffer, float val);
+    static void write_float8(char* buffer, double val);
 };
 
-blob helpers::parse_blob(const std::string_view& str) {
+bool helpers::parse_blob(const std::string_view& str, blob& res) {
     if(str.size()>=2 && str[0] == '\\' && str[1] == 'x') {
         // Hex format
-        blob res;
-        res.reserve((str.size()-2)/2);
-        for(size_t i=2 ; i<str.size() ; i+=2) {
-            char c = 0;
-            for(size_t j=0 ; j<2 && i+j<str.size() ; ++j) {
-                c <<= 4;
-                if(str[i+j] >= '0' && str[i+j] <= '9') {
-                    c |= (str[i+j] - '0');
-                } else if(str[i+j] >= 'a' && str[i+j] <= 'f') {
-                    c |= (str[i+j] - 'a' + 10);
-                } else if(str[i+j] >= 'A' && str[i+j] <= 'F') {
-                    c |= (str[i+j] - 'A' + 10);
-                } else {
-                    // Invalid character
-                    return {};
-                }
-            }
-            res.push_back(c);
-        }
-        return res;
+        res.resize((str.size()-2)/2);
+        return details::hex_decode(str.substr(2), res.data());
     } else {
-        // Escape format
-        blob res;
-        res.reserve(str.size());
-        for(size_t i=0 ; i<str.size() ; ++i) {
-            if(str[i] == '\\') {
-                if(i+1 < str.size()) {
-                    if(str[i+1] >= '0' && str[i+1] <= '3') {
-                        // Octal format
-                        char c = 0;
-                        for(size_t j=0 ; j<3 && i+1+j < str.size() && str[i+1+j]>='0' && str[i+1+j]<='7' ; ++j) {
-                            c <<= 3;
-                            c |= (str[i+1+j]-'0');
-                        }
-                        res.push_back(c);
-                        i += 3;
-                    } else if(str[i+1] == '\\') {
-                        res.push_back('\\');
-                        ++i;
-                    } else {
-                        // Invalid escape sequence
-                        return {};
-                    }
-                } else {
-                    // Invalid escape sequence
-                    return {};
-                }
-            } else {
-                res.push_back(str[i]);
-            }
-        }
-        return res;
+        return details::bytea_unescape(str, res);
+    }
+}
+
+blob helpers::parse_blob(const std::string_view& str) {
+    blob res;
+    if(!parse_blob(str, res)) {
+        // TODO throw exception
+        std::cerr << "Invalid bytea value" << std::endl;
+        return {};
     }
+    return res;
 }
 
 
@@ -145,49 +173,106 @@ value_type helpers::column_type_from_oid(Oid oid)
 }
 
 
+int16_t helpers::read_int16(const char* val)
+{
+    const auto* p = reinterpret_cast<const unsigned char*>(val);
+    return (int16_t) (uint16_t) ((p[0] << 8) | p[1]);
+}
+
+int32_t helpers::read_int32(const char* val)
+{
+    const auto* p = reinterpret_cast<const unsigned char*>(val);
+    return (int32_t) (((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | (uint32_t) p[3]);
+}
+
+int64_t helpers::read_int64(const char* val)
+{
+    const auto* p = reinterpret_cast<const unsigned char*>(val);
+    uint64_t res = 0;
+    for(size_t i=0; i<8; ++i) {
+        res = (res << 8) | p[i];
+    }
+    return (int64_t) res;
+}
+
+float helpers::read_float4(const char* val)
+{
+    uint32_t bits = (uint32_t) read_int32(val);
+    float res;
+    std::memcpy(&res, &bits, sizeof(res));
+    return res;
+}
+
+double helpers::read_float8(const char* val)
+{
+    uint64_t bits = (uint64_t) read_int64(val);
+    double res;
+    std::memcpy(&res, &bits, sizeof(res));
+    return res;
+}
+
+void helpers::write_int16(char* buffer, int16_t val)
+{
+    auto v = (uint16_t) val;
+    buffer[0] = (char) (v >> 8);
+    buffer[1] = (char) v;
+}
+
+void helpers::write_int32(char* buffer, int32_t val)
+{
+    auto v = (uint32_t) val;
+    for(int i=3; i>=0; --i) {
+        buffer[i] = (char) v;
+        v >>= 8;
+    }
+}
+
+void helpers::write_int64(char* buffer, int64_t val)
+{
+    auto v = (uint64_t) val;
+    for(int i=7; i>=0; --i) {
+        buffer[i] = (char) v;
+        v >>= 8;
+    }
+}
+
+void helpers::write_float4(char* buffer, float val)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    write_int32(buffer, (int32_t) bits);
+}
+
+void helpers::write_float8(char* buffer, double val)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    write_int64(buffer, (int64_t) bits);
+}
+
 value helpers::get_value(PGresult* res, unsigned int row, unsigned int col) {
     if (PQgetisnull(res, row, col)) {
         return {nullptr};
     }
+    return get_value(PQftype(res, col), PQfformat(res, col) != 0, PQgetvalue(res, row, col), PQgetlength(res, row, col));
+}
 
-    bool isBinary = PQfformat(res, col) != 0;
-    int size = PQgetlength(res, row, col);
-    const char *val = PQgetvalue(res, row, col);
-
+value helpers::get_value(Oid oid, bool isBinary, const char* val, int size) {
     if (isBinary) {
-        switch(PQftype(res, col)) {
+        // Binary values are sent in network byte order, with the size of the column type
+        switch(oid) {
             case BOOLOID:
-                // TODO EKI !!! What are the values ?
-                return value_type::BOOL;
+                return size == 1 ? value{*val != 0} : value{};
             case INT2OID:
+                return size == 2 ? value{(int) read_int16(val)} : value{};
             case INT4OID:
-                switch(size) {
-                    case sizeof(short):
-                        return (int) *(const short *) val;
-                    case sizeof(int):
-                        return (int) *(const int *) val;
-                    default:
-                        // TODO log an error or an exception
-                        return {};
-                }
+                return size == 4 ? value{(int) read_int32(val)} : value{};
             case INT8OID:
-                if(size == sizeof(int64_t)) {
-                    return (int64_t) *(const int64_t *) val;
-                } else {
-                    // TODO log an error or an exception
-                    return {};
-                }
+                return size == 8 ? value{read_int64(val)} : value{};
             case FLOAT4OID:
+                return size == 4 ? value{(double) read_float4(val)} : value{};
             case FLOAT8OID:
-                switch(size) {
-                    case sizeof(float):
-                        return (double) *(const float *) val;
-                    case sizeof(double ):
-                        return (double) *(const double *) val;
-                    default:
-                        // TODO log an error or an exception
-                        return {};
-                }
+                return size == 8 ? value{read_float8(val)} : value{};
             case TEXTOID:
             case VARCHAROID:
             case BPCHAROID:
@@ -195,14 +280,14 @@ value helpers::get_value(PGresult* res, unsigned int row, unsigned int col) {
             case CHAROID:
                 return std::string(val, val+size);
             case BYTEAOID:
-                // TODO To be tested ???
                 return blob{val, val+size};
-
             default:
+                // TODO throw exception
+                std::cerr << "Unsupported binary value of type " << oid << std::endl;
                 return {};
         }
     } else {
-        switch(PQftype(res, col)) {
+        switch(oid) {
             case BOOLOID:
                 // TODO EKI !!! What are the values ?
                 return *val == 't';
@@ -229,206 +314,169 @@ value helpers::get_value(PGresult* res, unsigned int row, unsigned int col) {
 
 }
 
-
-
-
-//
-// PostgreSQL's resultset iterator
-//
-
-class resultset_row_iterator_impl : public sqlcpp::resultset_row_iterator_impl, protected row_base
+std::shared_ptr<stats_result> helpers::get_stats(PGresult* res)
 {
-protected:
-    std::shared_ptr<PGresult> _stmt;
-    size_t _row = 0;
-
-public:
-    resultset_row_iterator_impl(std::shared_ptr<PGresult> stmt):
-        _stmt(stmt)
-    {}
-
-    virtual ~resultset_row_iterator_impl() = default;
-
-    bool ok() const;
-    operator bool() const { return ok(); }
-
-    const row_base& get() const override;
-    bool next() override;
-    bool different(const sqlcpp::resultset_row_iterator_impl& other) const override;
-
-    size_t size() const override;
-
-    value get_value(unsigned int index) const override;
-
-    std::string get_value_string(unsigned int index) const override;
-    blob get_value_blob(unsigned int index) const override;
-    bool get_value_bool(unsigned int index) const override;
-    int get_value_int(unsigned int index) const override;
-    int64_t get_value_int64(unsigned int index) const override;
-    double get_value_double(unsigned int index) const override;
-};
+    std::string str = PQcmdTuples(res);
+    unsigned long long affected_rows = !str.empty() ? std::stoull(str) : 0;
+    return std::make_shared<details::simple_stats_result>(affected_rows, PQoidValue(res));
+}
 
-const row_base& resultset_row_iterator_impl::get() const
+bool helpers::is_partial_result(ExecStatusType type)
 {
-    return *this;
+    return type == PGRES_SINGLE_TUPLE
+#ifdef LIBPQ_HAS_CHUNK_MODE
+        || type == PGRES_TUPLES_CHUNK
+#endif
+        ;
 }
 
-bool resultset_row_iterator_impl::next()
+void helpers::drain_results(PGconn* db)
 {
-    return _stmt && ++_row < PQntuples(_stmt.get());
+    while(PGresult* res = PQgetResult(db)) {
+        PQclear(res);
+    }
 }
 
-bool resultset_row_iterator_impl::ok() const
+void helpers::cancel_query(PGconn* db)
 {
-    return _stmt && _row < PQntuples(_stmt.get());
+    if(PGcancel* cancel = PQgetCancel(db); cancel != nullptr) {
+        char errbuf[256];
+        PQcancel(cancel, errbuf, sizeof(errbuf));
+        PQfreeCancel(cancel);
+    }
 }
 
-bool resultset_row_iterator_impl::different(const sqlcpp::resultset_row_iterator_impl& other) const
+std::string helpers::get_string(PGresult* res, unsigned int row, unsigned int col)
 {
-    if(auto impl = dynamic_cast<const resultset_row_iterator_impl*>(&other) ; impl!=nullptr) {
-        if(!ok() && !impl->ok()) {
-            // Both invalid, consider they are the same
-            return false;
-        } else {
-            // Both valid, compare stmt and row
-            return _stmt != impl->_stmt || _row != impl->_row;
-        }
-    } else {
-        // Not the same type, obviously different
-        return true;
-    }
+    return get_string(PQftype(res, col), PQfformat(res, col) != 0, PQgetvalue(res, row, col), PQgetlength(res, row, col));
 }
 
-size_t resultset_row_iterator_impl::size() const
+blob helpers::get_blob(PGresult* res, unsigned int row, unsigned int col)
 {
-    return PQnfields(_stmt.get());
+    return get_blob(PQftype(res, col), PQfformat(res, col) != 0, PQgetvalue(res, row, col), PQgetlength(res, row, col));
 }
 
-value resultset_row_iterator_impl::get_value(unsigned int index) const
+bool helpers::get_bool(PGresult* res, unsigned int row, unsigned int col)
 {
-    return helpers::get_value(_stmt.get(), _row, index);
+    return get_bool(PQftype(res, col), PQfformat(res, col) != 0, PQgetvalue(res, row, col), PQgetlength(res, row, col));
 }
 
-std::string resultset_row_iterator_impl::get_value_string(unsigned int index) const 
+int64_t helpers::get_int64(PGresult* res, unsigned int row, unsigned int col)
 {
-    if (PQgetisnull(_stmt.get(), _row, index)) {
-        return "NULL";
-    }
+    return get_int64(PQftype(res, col), PQfformat(res, col) != 0, PQgetvalue(res, row, col), PQgetlength(res, row, col));
+}
 
-    bool isBinary = PQfformat(_stmt.get(), index) != 0;
-    int size = PQgetlength(_stmt.get(), _row, index);
-    const char *val = PQgetvalue(_stmt.get(), _row, index);
+double helpers::get_double(PGresult* res, unsigned int row, unsigned int col)
+{
+    return get_double(PQftype(res, col), PQfformat(res, col) != 0, PQgetvalue(res, row, col), PQgetlength(res, row, col));
+}
 
-    if(isBinary) {
-        // TODO To be tested ???
-        return {val, val+size};
+std::string helpers::get_string(Oid oid, bool binary, const char* val, int size)
+{
+    if(binary) {
+        switch(oid) {
+            case BOOLOID:
+            case INT2OID:
+            case INT4OID:
+            case INT8OID:
+            case FLOAT4OID:
+            case FLOAT8OID:
+            case BYTEAOID:
+                return to_string(get_value(oid, binary, val, size));
+            case TEXTOID:
+            case VARCHAROID:
+            case BPCHAROID:
+            case NAMEOID:
+            case CHAROID:
+                return {val, val+size};
+            default:
+                // TODO throw exception
+                std::cerr << "Unsupported binary value of type " << oid << std::endl;
+                return {};
+        }
     } else {
         return {val, val+size};
     }
 }
 
-blob resultset_row_iterator_impl::get_value_blob(unsigned int index) const 
+blob helpers::get_blob(Oid oid, bool binary, const char* val, int size)
 {
-    if (PQgetisnull(_stmt.get(), _row, index)) {
-        return {};
-    }
-
-    bool isBinary = PQfformat(_stmt.get(), index) != 0;
-    int size = PQgetlength(_stmt.get(), _row, index);
-    const char *val = PQgetvalue(_stmt.get(), _row, index);
-
-    if(isBinary) {
-        // TODO To be tested ???
+    if(binary) {
         return {val, val+size};
     } else {
-        return helpers::parse_blob(std::string_view(val, size));
+        return parse_blob(std::string_view(val, size));
     }
 }
 
-bool resultset_row_iterator_impl::get_value_bool(unsigned int index) const
+bool helpers::get_bool(Oid oid, bool binary, const char* val, int size)
 {
-    if (PQgetisnull(_stmt.get(), _row, index)) {
-        return false;
-    }
-
-    bool isBinary = PQfformat(_stmt.get(), index) != 0;
-    int size = PQgetlength(_stmt.get(), _row, index);
-    const char *val = PQgetvalue(_stmt.get(), _row, index);
-
-    if(isBinary) {
-        // TODO Todo ???
-        return false;
+    if(binary) {
+        return oid == BOOLOID ? *val != 0 : to_bool(get_value(oid, binary, val, size));
     } else {
         return *val == 't';
     }
 }
 
-int resultset_row_iterator_impl::get_value_int(unsigned int index) const 
+int64_t helpers::get_int64(Oid oid, bool binary, const char* val, int size)
 {
-    if (PQgetisnull(_stmt.get(), _row, index)) {
-        return 0;
-    }
-
-    bool isBinary = PQfformat(_stmt.get(), index) != 0;
-    int size = PQgetlength(_stmt.get(), _row, index);
-    const char *val = PQgetvalue(_stmt.get(), _row, index);
-
-    if(isBinary) {
-        switch(size) {
-            case sizeof(short):
-                return (int) *(const short *) val;
-            case sizeof(int):
-                return (int) *(const int *) val;
+    if(binary) {
+        switch(oid) {
+            case INT2OID:
+                return size == 2 ? read_int16(val) : 0;
+            case INT4OID:
+                return size == 4 ? read_int32(val) : 0;
+            case INT8OID:
+                return size == 8 ? read_int64(val) : 0;
             default:
-                // TODO log an error or an exception
-                return 0;
+                return to_int64(get_value(oid, binary, val, size));
         }
     } else {
-        return std::stoi(val);
+        return std::stoll(val);
     }
 }
 
-int64_t resultset_row_iterator_impl::get_value_int64(unsigned int index) const 
+std::string_view helpers::get_view(Oid oid, bool binary, const char* val, int size, blob& buffer)
 {
-    if (PQgetisnull(_stmt.get(), _row, index)) {
-        return 0;
-    }
-
-    bool isBinary = PQfformat(_stmt.get(), index) != 0;
-    int size = PQgetlength(_stmt.get(), _row, index);
-    const char *val = PQgetvalue(_stmt.get(), _row, index);
-
-    if(isBinary) {
-        if(size == sizeof(int64_t)) {
-            return (int64_t) *(const int64_t *) val;
-        } else {
-            // TODO log an error or an exception
-            return 0;
-        }
-    } else {
-        return std::stoll(val);
+    switch(column_type_from_oid(oid)) {
+        case value_type::STRING:
+            return {val, (size_t) size};
+        case value_type::BLOB:
+            if(binary) {
+                return {val, (size_t) size};
+            }
+            if(!parse_blob(std::string_view(val, size), buffer)) {
+                // TODO throw exception
+                std::cerr << "Invalid bytea value" << std::endl;
+                return {};
+            }
+            return {reinterpret_cast<const char*>(buffer.data()), buffer.size()};
+        default:
+            return {};
     }
 }
 
-double resultset_row_iterator_impl::get_value_double(unsigned int index) const 
+size_t helpers::value_size(Oid oid, int size)
 {
-    if (PQgetisnull(_stmt.get(), _row, index)) {
-        return 0;
+    switch(column_type_from_oid(oid)) {
+        case value_type::STRING:
+        case value_type::BLOB:
+            // Text BYTEA values are counted encoded, as received
+            return size;
+        default:
+            return sizeof(int64_t);
     }
+}
 
-    bool isBinary = PQfformat(_stmt.get(), index) != 0;
-    int size = PQgetlength(_stmt.get(), _row, index);
-    const char *val = PQgetvalue(_stmt.get(), _row, index);
-
-    if(isBinary) {
-        switch(size) {
-            case sizeof(float):
-                return (double) *(const float *) val;
-            case sizeof(double ):
-                return (double) *(const double *) val;
+double helpers::get_double(Oid oid, bool binary, const char* val, int size)
+{
+    if(binary) {
+        switch(oid) {
+            case FLOAT4OID:
+                return size == 4 ? read_float4(val) : 0.0;
+            case FLOAT8OID:
+                return size == 8 ? read_float8(val) : 0.0;
             default:
-                // TODO log an error or an exception
-                return {};
+                return to_double(get_value(oid, binary, val, size));
         }
     } else {
         return std::stod(val);
@@ -438,84 +486,303 @@ double resultset_row_iterator_impl::get_value_double(unsigned int index) const
 
 
 //
-// PostgreSQL's resultset
+// PostgreSQL's result row view
 //
-class resultset : public sqlcpp::cursor_resultset
+
+// Row view reading values directly from a PGresult row
+class result_row : public row_base
 {
 protected:
-    std::shared_ptr<PGresult> _res;
+    PGresult* _res;
+    size_t _row;
+    // Decoded text BYTEA values for views, by column
+    mutable std::vector<blob> _buffers;
 
-public:
-    resultset(PGresult* res) :
-        _res(res, PQclear)
-        {}
+    std::string_view get_view(unsigned int index) const;
 
-    virtual ~resultset() = default;
-
-    unsigned long long affected_rows() const override;
-    unsigned long long last_insert_id() const override;
+public:
+    explicit result_row(PGresult* res = nullptr, size_t row = 0) :
+        _res(res), _row(row)
+    {}
 
-    unsigned int column_count() const override;
-    unsigned int row_count() const /*override*/;
+    virtual ~result_row() = default;
 
-    std::string column_name(unsigned int index) const override;
-    unsigned int column_index(const std::string& name) const override;
-    std::string column_origin_name(unsigned int index) const override;
-    std::string table_origin_name(unsigned int index) const override;
-    value_type column_type(unsigned int index) const override;
+    void set(PGresult* res, size_t row) { _res = res; _row = row; }
 
-    bool has_row() const override;
+    size_t size() const override;
 
-    sqlcpp::resultset_row_iterator begin() const override;
-    sqlcpp::resultset_row_iterator end() const override;
+    value get_value(unsigned int index) const override;
 
+    std::string get_value_string(unsigned int index) const override;
+    blob get_value_blob(unsigned int index) const override;
+    bool get_value_bool(unsigned int index) const override;
+    int get_value_int(unsigned int index) const override;
+    int64_t get_value_int64(unsigned int index) const override;
+    double get_value_double(unsigned int index) const override;
+    std::string_view get_value_string_view(unsigned int index) const override;
+    blob_span get_value_blob_span(unsigned int index) const override;
+    bool is_null(unsigned int index) const override;
+    value_type get_value_type(unsigned int index) const override;
+    size_t value_size(unsigned int index) const override;
 };
 
-unsigned long long resultset::affected_rows() const {
-    std::string str = PQcmdTuples(_res.get());
-    return str.empty() ? 0 : std::stoull(str);
+size_t result_row::size() const
+{
+    return PQnfields(_res);
 }
 
-unsigned long long resultset::last_insert_id() const {
-    return PQoidValue(_res.get());
+value result_row::get_value(unsigned int index) const
+{
+    return helpers::get_value(_res, _row, index);
 }
 
-unsigned int resultset::column_count() const
+std::string result_row::get_value_string(unsigned int index) const
 {
-    int res = PQnfields(_res.get());
-    return res;
+    if (PQgetisnull(_res, _row, index)) {
+        return "NULL";
+    }
+    return helpers::get_string(_res, _row, index);
 }
 
-unsigned int resultset::row_count() const
+blob result_row::get_value_blob(unsigned int index) const
 {
-    return PQntuples(_res.get());
+    if (PQgetisnull(_res, _row, index)) {
+        return {};
+    }
+    return helpers::get_blob(_res, _row, index);
 }
 
-std::string resultset::column_name(unsigned int index) const
+bool result_row::get_value_bool(unsigned int index) const
 {
-    return PQfname(_res.get(), index);
+    if (PQgetisnull(_res, _row, index)) {
+        return false;
+    }
+    return helpers::get_bool(_res, _row, index);
 }
 
-unsigned int resultset::column_index(const std::string& name) const
+int result_row::get_value_int(unsigned int index) const
 {
-    int res = PQfnumber(_res.get(), name.c_str());
-    if(res >= 0) {
-        return res;
+    if (PQgetisnull(_res, _row, index)) {
+        return 0;
     }
-    return std::numeric_limits<unsigned int>::max();
+    if (PQfformat(_res, index) == 0) {
+        return std::stoi(PQgetvalue(_res, _row, index));
+    }
+    return (int) helpers::get_int64(_res, _row, index);
 }
 
-std::string resultset::column_origin_name(unsigned int index) const 
+int64_t result_row::get_value_int64(unsigned int index) const
 {
-    // Not supported directly for PostgreSQL
-    // Look at PQftablecol
-    // TODO
-    return "";
+    if (PQgetisnull(_res, _row, index)) {
+        return 0;
+    }
+    return helpers::get_int64(_res, _row, index);
 }
 
-std::string resultset::table_origin_name(unsigned int index) const
+double result_row::get_value_double(unsigned int index) const
 {
-    // Not supported for PostgreSQL
+    if (PQgetisnull(_res, _row, index)) {
+        return 0;
+    }
+    return helpers::get_double(_res, _row, index);
+}
+
+std::string_view result_row::get_view(unsigned int index) const
+{
+    if (PQgetisnull(_res, _row, index)) {
+        return {};
+    }
+    if (_buffers.size() <= index) {
+        _buffers.resize(index + 1);
+    }
+    return helpers::get_view(PQftype(_res, index), PQfformat(_res, index) != 0, PQgetvalue(_res, _row, index), PQgetlength(_res, _row, index), _buffers[index]);
+}
+
+std::string_view result_row::get_value_string_view(unsigned int index) const
+{
+    return get_view(index);
+}
+
+blob_span result_row::get_value_blob_span(unsigned int index) const
+{
+    std::string_view data = get_view(index);
+    return {reinterpret_cast<const unsigned char*>(data.data()), data.size()};
+}
+
+bool result_row::is_null(unsigned int index) const
+{
+    return PQgetisnull(_res, _row, index) != 0;
+}
+
+value_type result_row::get_value_type(unsigned int index) const
+{
+    if (PQgetisnull(_res, _row, index)) {
+        return value_type::NULL_VALUE;
+    }
+    return helpers::column_type_from_oid(PQftype(_res, index));
+}
+
+size_t result_row::value_size(unsigned int index) const
+{
+    if (PQgetisnull(_res, _row, index)) {
+        return 0;
+    }
+    return helpers::value_size(PQftype(_res, index), PQgetlength(_res, _row, index));
+}
+
+
+
+//
+// PostgreSQL's resultset iterator
+//
+
+class resultset_row_iterator_impl : public sqlcpp::resultset_row_iterator_impl, protected result_row
+{
+protected:
+    std::shared_ptr<PGresult> _stmt;
+
+    void reset(std::shared_ptr<PGresult> stmt);
+
+public:
+    resultset_row_iterator_impl(std::shared_ptr<PGresult> stmt):
+        result_row(stmt.get()),
+        _stmt(stmt)
+    {}
+
+    virtual ~resultset_row_iterator_impl() = default;
+
+    bool ok() const;
+    operator bool() const { return ok(); }
+
+    const row_base& get() const override;
+    bool next() override;
+    bool different(const sqlcpp::resultset_row_iterator_impl& other) const override;
+};
+
+void resultset_row_iterator_impl::reset(std::shared_ptr<PGresult> stmt)
+{
+    _stmt = std::move(stmt);
+    set(_stmt.get(), 0);
+}
+
+const row_base& resultset_row_iterator_impl::get() const
+{
+    return *this;
+}
+
+bool resultset_row_iterator_impl::next()
+{
+    return _stmt && ++_row < PQntuples(_stmt.get());
+}
+
+bool resultset_row_iterator_impl::ok() const
+{
+    return _stmt && _row < PQntuples(_stmt.get());
+}
+
+bool resultset_row_iterator_impl::different(const sqlcpp::resultset_row_iterator_impl& other) const
+{
+    if(auto impl = dynamic_cast<const resultset_row_iterator_impl*>(&other) ; impl!=nullptr) {
+        if(!ok() && !impl->ok()) {
+            // Both invalid, consider they are the same
+            return false;
+        } else {
+            // Both valid, compare stmt and row
+            return _stmt != impl->_stmt || _row != impl->_row;
+        }
+    } else {
+        // Not the same type, obviously different
+        return true;
+    }
+}
+
+
+
+//
+// PostgreSQL's resultset
+//
+class resultset : public sqlcpp::cursor_resultset
+{
+protected:
+    std::shared_ptr<PGresult> _res;
+    // Next row of fetch_batch() in _res
+    int _batch_row = 0;
+
+    // Replace _res by the next chunk of rows, if any
+    virtual bool next_chunk() { return false; }
+
+public:
+    resultset(PGresult* res) :
+        _res(res, PQclear)
+        {}
+
+    virtual ~resultset() = default;
+
+    unsigned long long affected_rows() const override;
+    unsigned long long last_insert_id() const override;
+
+    unsigned int column_count() const override;
+    unsigned int row_count() const /*override*/;
+
+    std::string column_name(unsigned int index) const override;
+    unsigned int column_index(const std::string& name) const override;
+    std::string column_origin_name(unsigned int index) const override;
+    std::string table_origin_name(unsigned int index) const override;
+    value_type column_type(unsigned int index) const override;
+
+    bool has_row() const override;
+
+    sqlcpp::resultset_row_iterator begin() const override;
+    sqlcpp::resultset_row_iterator end() const override;
+
+    size_t fetch_batch(span<const batch_column> columns) override;
+};
+
+unsigned long long resultset::affected_rows() const {
+    std::string str = PQcmdTuples(_res.get());
+    return str.empty() ? 0 : std::stoull(str);
+}
+
+unsigned long long resultset::last_insert_id() const {
+    return PQoidValue(_res.get());
+}
+
+unsigned int resultset::column_count() const
+{
+    int res = PQnfields(_res.get());
+    return res;
+}
+
+unsigned int resultset::row_count() const
+{
+    return PQntuples(_res.get());
+}
+
+std::string resultset::column_name(unsigned int index) const
+{
+    return PQfname(_res.get(), index);
+}
+
+unsigned int resultset::column_index(const std::string& name) const
+{
+    int res = PQfnumber(_res.get(), name.c_str());
+    if(res >= 0) {
+        return res;
+    }
+    return std::numeric_limits<unsigned int>::max();
+}
+
+std::string resultset::column_origin_name(unsigned int index) const 
+{
+    // Not supported directly for PostgreSQL
+    // Look at PQftablecol
+    // TODO
+    return "";
+}
+
+std::string resultset::table_origin_name(unsigned int index) const
+{
+    // Not supported for PostgreSQL
     // Look at PQftable
     // TODO
     return "";
@@ -529,11 +796,7 @@ value_type resultset::column_type(unsigned int index) const
 bool resultset::has_row() const
 {
     ExecStatusType type = PQresultStatus(_res.get());
-    return (type == PGRES_TUPLES_OK
-// TODO Support single-row or tuple chunk modes
-//            || type == PGRES_SINGLE_TUPLE || type == PGRES_TUPLES_CHUNK
-
-            )
+    return (type == PGRES_TUPLES_OK || helpers::is_partial_result(type))
         && PQntuples(_res.get()) > 0;
 }
 
@@ -547,6 +810,138 @@ sqlcpp::resultset_row_iterator resultset::end() const
     return std::move(sqlcpp::cursor_resultset::create_iterator(std::make_unique<resultset_row_iterator_impl>(nullptr)));
 }
 
+size_t resultset::fetch_batch(span<const batch_column> columns)
+{
+    size_t capacity = batch_column::capacity(columns);
+    size_t count = 0;
+    size_t values = 0;
+    while (count < capacity) {
+        if (_batch_row >= PQntuples(_res.get())) {
+            if (!next_chunk()) {
+                break;
+            }
+            _batch_row = 0;
+            continue;
+        }
+        PGresult* res = _res.get();
+        for (const auto& column : columns) {
+            if (PQgetisnull(res, _batch_row, column.index())) {
+                column.set_null(count);
+                continue;
+            } else if (column.type() == value_type::INT64) {
+                column.set(count, helpers::get_int64(res, _batch_row, column.index()));
+            } else {
+                column.set(count, helpers::get_double(res, _batch_row, column.index()));
+            }
+            ++values;
+        }
+        ++_batch_row;
+        ++count;
+    }
+    if(_observation) {
+        _observation->fetched(count, values * sizeof(int64_t));
+    }
+    return count;
+}
+
+
+
+//
+// PostgreSQL's streaming resultset
+// Rows are received one by one (single-row mode) or by chunks, only the current chunk is held in memory.
+//
+
+class streaming_resultset : public resultset, public std::enable_shared_from_this<streaming_resultset>
+{
+protected:
+    std::shared_ptr<PGconn> _db;
+    bool _done = false;
+
+    bool next_chunk() override { return fetch_next() != nullptr; }
+
+public:
+    streaming_resultset(std::shared_ptr<PGconn> db, PGresult* res) :
+        resultset(res),
+        _db(std::move(db))
+        {}
+
+    ~streaming_resultset() override;
+
+    std::shared_ptr<PGresult> fetch_next();
+
+    sqlcpp::resultset_row_iterator begin() const override;
+};
+
+class streaming_row_iterator_impl : public resultset_row_iterator_impl
+{
+protected:
+    std::shared_ptr<streaming_resultset> _resultset;
+
+public:
+    streaming_row_iterator_impl(std::shared_ptr<streaming_resultset> resultset, std::shared_ptr<PGresult> res) :
+        resultset_row_iterator_impl(std::move(res)),
+        _resultset(std::move(resultset))
+    {}
+
+    bool next() override;
+};
+
+streaming_resultset::~streaming_resultset()
+{
+    if(!_done) {
+        // Not fully consumed, cancel the query and flush pending results to release the connection
+        helpers::cancel_query(_db.get());
+        helpers::drain_results(_db.get());
+    }
+}
+
+std::shared_ptr<PGresult> streaming_resultset::fetch_next()
+{
+    if(_done) {
+        return nullptr;
+    }
+    PGresult* res = PQgetResult(_db.get());
+    ExecStatusType type = PQresultStatus(res);
+    if(res != nullptr && helpers::is_partial_result(type)) {
+        _res.reset(res, PQclear);
+        return _res;
+    }
+
+    // End of rows: keep the final result for statistics
+    if(type == PGRES_TUPLES_OK || type == PGRES_COMMAND_OK) {
+        _res.reset(res, PQclear);
+    } else if(res != nullptr) {
+        std::cerr << "Failed to fetch rows: " << PQresultErrorMessage(res) << std::endl;
+        // TODO throw exception
+        PQclear(res);
+    }
+    helpers::drain_results(_db.get());
+    _done = true;
+    return nullptr;
+}
+
+sqlcpp::resultset_row_iterator streaming_resultset::begin() const
+{
+    std::shared_ptr<streaming_resultset> self = const_cast<streaming_resultset*>(this)->shared_from_this();
+    return std::move(sqlcpp::cursor_resultset::create_iterator(std::make_shared<streaming_row_iterator_impl>(self, has_row() ? _res : nullptr)));
+}
+
+bool streaming_row_iterator_impl::next()
+{
+    if(resultset_row_iterator_impl::next()) {
+        return true;
+    }
+    while(_resultset) {
+        reset(_resultset->fetch_next());
+        if(!_stmt) {
+            _resultset.reset();
+        } else if(PQntuples(_stmt.get()) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 
 
 //
@@ -560,20 +955,48 @@ protected:
     std::string _stmt_name;
     mutable std::shared_ptr<PGresult> _stmt_info;
     std::vector<value> _params;
-
+    int _result_format = 0;
+    bool _binary_params = false;
+    unsigned int _chunk_size = 0;
+
+    // Parameter buffers, reused across executions
+    std::string _param_buffer;
+    std::vector<std::string> _param_texts;
+    std::vector<const char*> _param_values;
+    std::vector<int> _param_lengths;
+    std::vector<int> _param_formats;
+
+    const PGresult* statement_info() const;
+    bool binary_decodable() const;
+    void prepare_parameters();
     PGresult* execute_prepared();
+    bool send_query();
+    bool send_prepared();
+    void consume_result(PGresult* res, const std::function<void(const row_base&)>& func, details::query_observation* observation);
 
 public:
-    explicit statement(std::shared_ptr<PGconn> db, const std::string& stmt_name) :
-        _db(db), _stmt_name(stmt_name)
-        {}
+    explicit statement(std::shared_ptr<PGconn> db, const std::string& stmt_name, bool binary_results = false, bool binary_params = false, unsigned int chunk_size = 0) :
+        _db(db), _stmt_name(stmt_name), _binary_params(binary_params), _chunk_size(chunk_size)
+        {
+            // Described now, as synchronous describes are not possible once executions are pipelined
+            if(binary_params) {
+                statement_info();
+            }
+            _result_format = binary_results && binary_decodable() ? 1 : 0;
+        }
 
     virtual ~statement() {}
 
+    friend class pipeline;
+
     std::shared_ptr<sqlcpp::cursor_resultset> execute() override;
     void execute(std::function<void(const row_base&)> func) override;
     std::shared_ptr<sqlcpp::buffered_resultset> execute_buffered() override;
 
+    std::shared_ptr<stats_result> execute_array() override;
+
+    void reset() override;
+
     unsigned int parameter_count() const override;
     int parameter_index(const std::string& name) const override;
     std::string parameter_name(unsigned int index) const override;
@@ -599,52 +1022,219 @@ public:
     statement& bind(unsigned int index, const value& value) override;
 };
 
-PGresult* statement::execute_prepared()
+const PGresult* statement::statement_info() const
 {
-    size_t sz = _params.size();
-
-    std::vector<std::string> values;
-    values.reserve(sz);
-    std::vector<const char*> rc;
-    rc.reserve(sz);
-
-    for(int i=1; i<sz; i++) {
-        const auto& v = _params[i];
-        std::visit([&](auto&& arg) {
-            using T = std::decay_t<decltype(arg)>;
-            if constexpr(std::is_same_v<T, std::monostate>) {
-                values.emplace_back("");
-                rc.push_back(nullptr);
-            } else if constexpr(std::is_same_v<T, std::nullptr_t>) {
-                values.emplace_back("");
-                rc.push_back(nullptr);
-            } else if constexpr(std::is_same_v<T, std::string>) {
-                values.push_back(arg);
-                rc.push_back(values.back().c_str());
-            } else if constexpr(std::is_same_v<T, blob>) {
-                values.push_back("\\x" + details::blob_to_hex_string(arg));
-                rc.push_back(values.back().c_str());
-            } else if constexpr(std::is_same_v<T, bool>) {
-                values.push_back(arg ? "TRUE" : "FALSE");
-                rc.push_back(values.back().c_str());
-            } else {
-                values.push_back(std::to_string(arg));
-                rc.push_back(values.back().c_str());
-            }
-        }, v);
+    if(!_stmt_info) {
+        PGconn* db = _db.lock().get();
+#ifdef LIBPQ_HAS_PIPELINING
+        // libpq rejects synchronous calls in pipeline mode
+        if(PQpipelineStatus(db) != PQ_PIPELINE_OFF) {
+            return nullptr;
+        }
+#endif
+        PGresult* res = PQdescribePrepared(db, _stmt_name.c_str());
+        if(PQresultStatus(res) != PGRES_COMMAND_OK) {
+            // TODO process error, throw exception
+            PQclear(res);
+            return nullptr;
+        }
+        _stmt_info = std::shared_ptr<PGresult>(res , PQclear);
     }
-
-    return PQexecPrepared(_db.lock().get(), _stmt_name.c_str(), rc.size(), rc.data(), nullptr, nullptr, 0);
+    return _stmt_info.get();
 }
 
-std::shared_ptr<sqlcpp::cursor_resultset> statement::execute()
+bool statement::binary_decodable() const
 {
+    const PGresult* info = statement_info();
+    if(!info) {
+        return false;
+    }
+    for(int col = 0; col < PQnfields(info); ++col) {
+        if(helpers::column_type_from_oid(PQftype(info, col)) == value_type::UNSUPPORTED) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void statement::prepare_parameters()
+{
+    // Parameter indexes start at 1, index 0 is not used
+    size_t count = _params.size() > 1 ? _params.size() - 1 : 0;
+
+    _param_values.assign(count, nullptr);
+    _param_lengths.assign(count, 0);
+    _param_formats.assign(count, 0);
+    if(_param_texts.size() < count) {
+        _param_texts.resize(count);
+    }
+    // One fixed-size slot per parameter for binary scalars, so pointers stay valid while filling
+    _param_buffer.resize(count * sizeof(int64_t));
+
+    // Parameter types are needed to send values in the binary representation expected by the server
+    const PGresult* info = _binary_params ? statement_info() : nullptr;
+    int info_count = info != nullptr ? PQnparams(info) : 0;
+
+    for(size_t slot=0; slot<count; ++slot) {
+        Oid oid = (int)slot < info_count ? PQparamtype(info, slot) : 0;
+        char* scratch = _param_buffer.data() + slot * sizeof(int64_t);
+        std::string& text = _param_texts[slot];
+
+        auto set_binary = [&](const char* data, int length) {
+            _param_values[slot] = data;
+            _param_lengths[slot] = length;
+            _param_formats[slot] = 1;
+        };
+        auto set_text = [&](const char* str) {
+            _param_values[slot] = str;
+        };
+
+        std::visit([&](auto&& arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr(std::is_same_v<T, std::monostate> || std::is_same_v<T, std::nullptr_t>) {
+                // NULL
+            } else if constexpr(std::is_same_v<T, std::string>) {
+                set_text(arg.c_str());
+            } else if constexpr(std::is_same_v<T, blob>) {
+                if(oid == BYTEAOID) {
+                    // Sent raw, pointing directly to the bound value
+                    set_binary(arg.empty() ? "" : reinterpret_cast<const char*>(arg.data()), arg.size());
+                } else {
+                    text.resize(2 + arg.size() * 2);
+                    text[0] = '\\';
+                    text[1] = 'x';
+                    details::hex_encode(arg, &text[2]);
+                    set_text(text.c_str());
+                }
+            } else if constexpr(std::is_same_v<T, bool>) {
+                if(oid == BOOLOID) {
+                    scratch[0] = arg ? 1 : 0;
+                    set_binary(scratch, 1);
+                } else {
+                    set_text(arg ? "TRUE" : "FALSE");
+                }
+            } else if constexpr(std::is_same_v<T, int> || std::is_same_v<T, int64_t>) {
+                if(oid == INT8OID) {
+                    helpers::write_int64(scratch, arg);
+                    set_binary(scratch, 8);
+                } else if(oid == INT4OID && arg >= std::numeric_limits<int32_t>::min() && arg <= std::numeric_limits<int32_t>::max()) {
+                    helpers::write_int32(scratch, (int32_t) arg);
+                    set_binary(scratch, 4);
+                } else if(oid == INT2OID && arg >= std::numeric_limits<int16_t>::min() && arg <= std::numeric_limits<int16_t>::max()) {
+                    helpers::write_int16(scratch, (int16_t) arg);
+                    set_binary(scratch, 2);
+                } else {
+                    text = std::to_string(arg);
+                    set_text(text.c_str());
+                }
+            } else if constexpr(std::is_same_v<T, double>) {
+                if(oid == FLOAT8OID) {
+                    helpers::write_float8(scratch, arg);
+                    set_binary(scratch, 8);
+                } else if(oid == FLOAT4OID) {
+                    helpers::write_float4(scratch, (float) arg);
+                    set_binary(scratch, 4);
+                } else {
+                    text = std::to_string(arg);
+                    set_text(text.c_str());
+                }
+            }
+        }, _params[slot + 1]);
+    }
+}
+
+PGresult* statement::execute_prepared()
+{
+    prepare_parameters();
+    return PQexecPrepared(_db.lock().get(), _stmt_name.c_str(), _param_values.size(), _param_values.data(),
+        _param_lengths.data(), _param_formats.data(), _result_format);
+}
+
+bool statement::send_query()
+{
+    prepare_parameters();
+    PGconn* db = _db.lock().get();
+    if(!PQsendQueryPrepared(db, _stmt_name.c_str(), _param_values.size(), _param_values.data(),
+            _param_lengths.data(), _param_formats.data(), _result_format)) {
+        std::cerr << "Failed to execute statement: " << PQerrorMessage(db) << std::endl;
+        // TODO throw exception
+        return false;
+    }
+    return true;
+}
+
+bool statement::send_prepared()
+{
+    if(!send_query()) {
+        return false;
+    }
+    PGconn* db = _db.lock().get();
+#ifdef LIBPQ_HAS_CHUNK_MODE
+    int rc = _chunk_size > 1 ? PQsetChunkedRowsMode(db, _chunk_size) : PQsetSingleRowMode(db);
+#else
+    int rc = PQsetSingleRowMode(db);
+#endif
+    if(!rc) {
+        // Not fatal, results will be retrieved at once
+        std::cerr << "Failed to set row streaming mode: " << PQerrorMessage(db) << std::endl;
+    }
+    return true;
+}
+
+void statement::consume_result(PGresult* res, const std::function<void(const row_base&)>& func, details::query_observation* observation)
+{
+    // Values are read directly from the result, nothing is copied for each row
+    result_row row;
+    int row_count = PQntuples(res);
+    for (int row_index = 0; row_index < row_count; ++row_index) {
+        row.set(res, row_index);
+        if(observation) {
+            observation->fetched(row);
+        }
+        func(row);
+    }
+}
+
+std::shared_ptr<sqlcpp::cursor_resultset> statement::execute()
+{
+    std::shared_ptr<details::query_observation> observation = observe();
+    auto observed = [&](std::shared_ptr<sqlcpp::cursor_resultset> rset) {
+        if(observation) {
+            observation->executed();
+            rset->observe(std::move(observation));
+        }
+        return rset;
+    };
+
+    if(_chunk_size > 0) {
+        std::shared_ptr<PGconn> db = _db.lock();
+        if(!send_prepared()) {
+            return {};
+        }
+        PGresult *res = PQgetResult(db.get());
+        switch(PQresultStatus(res)) {
+            case PGRES_COMMAND_OK:
+            case PGRES_TUPLES_OK:
+                // No row at all
+                helpers::drain_results(db.get());
+                return observed(std::make_shared<resultset>(res));
+            default:
+                if(helpers::is_partial_result(PQresultStatus(res))) {
+                    return observed(std::make_shared<streaming_resultset>(db, res));
+                }
+                std::cerr << "Failed to execute statement: " << PQerrorMessage(db.get()) << std::endl;
+                PQclear(res);
+                helpers::drain_results(db.get());
+                // TODO throw exception
+                return {};
+        }
+    }
+
     PGresult *res = execute_prepared();
-    // TODO support binary format for slight better performances
     switch(PQresultStatus(res)) {
         case PGRES_COMMAND_OK:
         case PGRES_TUPLES_OK:
-            return std::make_shared<resultset>(res);
+            return observed(std::make_shared<resultset>(res));
         default:
             std::cerr << "Failed to execute statement: " << PQerrorMessage(_db.lock().get()) << std::endl;
             PQclear(res);
@@ -655,250 +1245,1254 @@ std::shared_ptr<sqlcpp::cursor_resultset> statement::execute()
 
 void statement::execute(std::function<void(const row_base&)> func)
 {
+    std::shared_ptr<details::query_observation> observation = observe();
+    if(_chunk_size > 0) {
+        std::shared_ptr<PGconn> db = _db.lock();
+        if(!send_prepared()) {
+            return;
+        }
+        try {
+            bool first = true;
+            while(PGresult *res = PQgetResult(db.get())) {
+                std::unique_ptr<PGresult, void(*)(PGresult*)> guard(res, PQclear);
+                if(observation && first) {
+                    observation->executed();
+                }
+                first = false;
+                ExecStatusType type = PQresultStatus(res);
+                if(type == PGRES_TUPLES_OK || helpers::is_partial_result(type)) {
+                    consume_result(res, func, observation.get());
+                } else if(type != PGRES_COMMAND_OK) {
+                    std::cerr << "Failed to execute statement: " << PQresultErrorMessage(res) << std::endl;
+                    // TODO throw exception
+                }
+            }
+        } catch(...) {
+            // Cancel the query so the remaining rows are not received, then flush pending results to release the connection
+            helpers::cancel_query(db.get());
+            helpers::drain_results(db.get());
+            throw;
+        }
+        return;
+    }
+
+    PGresult *res = execute_prepared();
+    switch(PQresultStatus(res)) {
+        case PGRES_COMMAND_OK:
+        case PGRES_TUPLES_OK: {
+            std::shared_ptr<PGresult> guard(res, PQclear);
+            if(observation) {
+                observation->executed();
+            }
+            consume_result(res, func, observation.get());
+            break;
+        }
+        default:
+            std::cerr << "Failed to execute statement: " << PQerrorMessage(_db.lock().get()) << std::endl;
+            // TODO throw exception
+            PQclear(res);
+    }
+}
+
+std::shared_ptr<sqlcpp::buffered_resultset> statement::execute_buffered()
+{
+    std::shared_ptr<details::query_observation> observation = observe();
     PGresult *res = execute_prepared();
-    // TODO support binary format for slight better performances
     switch(PQresultStatus(res)) {
         case PGRES_COMMAND_OK:
         case PGRES_TUPLES_OK: {
+            if(observation) {
+                observation->executed();
+            }
+            auto buff = std::make_shared<details::generic_buffered_resultset>();
+
+            std::string affected_rows_str = PQcmdTuples(res);
+            unsigned long long affected_rows = affected_rows_str.empty() ? 0 : std::stoull(affected_rows_str);
+            unsigned long long last_insert_id = PQoidValue(res);
+
             int col_count = PQnfields(res);
+            for (int index = 0; index < col_count; ++index) {
+                std::string col_name = PQfname(res, index);
+                value_type col_type = helpers::column_type_from_oid(PQftype(res, index));
+                std::string column_origin_name; // TODO not supported directly by PGSQL
+                std::string table_origin_name; // TODO not supported directly by PGSQL
+                buff->add_column(col_name, col_type, column_origin_name, table_origin_name);
+            }
+
+            // Copy string and blob payloads straight from the result into the resultset arena
+            result_row row(res);
             int row_count = PQntuples(res);
             for (int row_index = 0; row_index < row_count; ++row_index) {
-                details::generic_row row;
+                row.set(res, row_index);
                 for (int col_index = 0; col_index < col_count; ++col_index) {
-                    row.add_value(helpers::get_value(res, row_index, col_index));
+                    if (PQgetisnull(res, row_index, col_index)) {
+                        buff->add_value(nullptr);
+                        continue;
+                    }
+                    switch (helpers::column_type_from_oid(PQftype(res, col_index))) {
+                        case value_type::STRING:
+                            buff->add_string(row.get_value_string_view(col_index));
+                            break;
+                        case value_type::BLOB:
+                            buff->add_blob(row.get_value_blob_span(col_index));
+                            break;
+                        default:
+                            buff->add_value(helpers::get_value(res, row_index, col_index));
+                            break;
+                    }
                 }
-                func(row);
+                buff->end_row();
             }
             PQclear(res);
-            break;
+            if(observation) {
+                observation->fetched(*buff);
+            }
+            return buff;
         }
         default:
             std::cerr << "Failed to execute statement: " << PQerrorMessage(_db.lock().get()) << std::endl;
-            // TODO throw exception
             PQclear(res);
+            // TODO throw exception
+            return {};
+    }
+
+    return {};
+}
+
+std::shared_ptr<stats_result> statement::execute_array()
+{
+    std::optional<size_t> rows = array_size();
+    if(!rows) {
+        // TODO throw exception
+        return {};
+    }
+    std::shared_ptr<details::query_observation> observation = observe();
+    std::shared_ptr<PGconn> db = _db.lock();
+
+    auto run = [&](const char* command) {
+        PGresult* res = PQexec(db.get(), command);
+        bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+        if(!ok) {
+            std::cerr << "Failed to execute " << command << ": " << PQerrorMessage(db.get()) << std::endl;
+        }
+        PQclear(res);
+        return ok;
+    };
+
+    // Run all rows in one transaction, unless one is already open,
+    // so the pipeline can be synchronized by chunks without committing partial batches
+    bool transaction = PQtransactionStatus(db.get()) == PQTRANS_IDLE;
+    if(transaction && !run("BEGIN")) {
+        // TODO throw exception
+        return {};
+    }
+
+    bool failed = false;
+    unsigned long long affected_rows = 0;
+    unsigned long long last_insert_id = 0;
+    {
+        pipeline pipe(db, 1000);
+        for(size_t row = 0; row < *rows; ++row) {
+            bind_array_row(row);
+            pipe.execute(*this);
+        }
+        for(const auto& res : pipe.sync()) {
+            if(!res) {
+                failed = true;
+                continue;
+            }
+            affected_rows += res->affected_rows();
+            last_insert_id = res->last_insert_id();
+        }
+    }
+
+    if(transaction && !run(failed ? "ROLLBACK" : "COMMIT")) {
+        failed = true;
+    }
+    if(failed) {
+        // TODO throw exception
+        return {};
+    }
+    if(observation) {
+        observation->executed(false);
+    }
+    return std::make_shared<details::simple_stats_result>(affected_rows, last_insert_id);
+}
+
+void statement::reset()
+{
+    sqlcpp::statement::reset();
+    // Parameters are all NULL until bound again
+    std::fill(_params.begin(), _params.end(), value(nullptr));
+}
+
+unsigned int statement::parameter_count() const
+{
+    const PGresult* info = statement_info();
+    return info != nullptr ? PQnparams(info) : 0;
+}
+
+int statement::parameter_index(const std::string& name) const 
+{
+    // Parameter names not supported for PostgreSQL yet
+    // TODO
+    return -1;
+}
+
+std::string statement::parameter_name(unsigned int index) const 
+{
+    // Parameter names not supported for PostgreSQL yet
+    // TODO
+    return "";
+}
+
+statement& statement::bind(const std::string& name, std::nullptr_t) 
+{
+    // Parameter names not supported for PostgreSQL yet
+    // TODO
+    return *this;
+}
+
+statement& statement::bind(const std::string& name, const std::string& value)
+{
+    // Parameter names not supported for PostgreSQL yet
+    // TODO
+    return *this;
+}
+
+statement& statement::bind(const std::string& name, const std::string_view& value)
+{
+    // Parameter names not supported for PostgreSQL yet
+    // TODO
+    return *this;
+}
+
+statement& statement::bind(const std::string& name, const blob& value) 
+{
+    // Parameter names not supported for PostgreSQL yet
+    // TODO
+    return *this;
+}
+
+statement& statement::bind(const std::string& name, bool value)
+{
+    // Parameter names not supported for PostgreSQL yet
+    // TODO
+    return *this;
+}
+
+statement& statement::bind(const std::string& name, int value)
+{
+    // Parameter names not supported for PostgreSQL yet
+    // TODO
+    return *this;
+}
+
+statement& statement::bind(const std::string& name, int64_t value)  
+{
+    // Parameter names not supported for PostgreSQL yet
+    // TODO
+    return *this;
+}
+
+statement& statement::bind(const std::string& name, double value)  
+{
+    // Parameter names not supported for PostgreSQL yet
+    // TODO
+    return *this;
+}
+
+statement& statement::bind(const std::string& name, const value& value)  
+{
+    // Parameter names not supported for PostgreSQL yet
+    // TODO
+//    std::visit([&](auto&& arg) {
+//        bind(name, arg);
+//    }, value);
+    return *this;
+}
+
+static inline std::vector<value>& ensure(std::vector<value>& params, unsigned int index)
+{
+    if(params.size() <= index) {
+        params.resize(index + 1);
+    }
+    return params;
+}
+
+
+statement& statement::bind(unsigned int index, std::nullptr_t)  
+{
+    ensure(_params, index)[index] = nullptr;
+    // TODO process error, throw exception
+    return *this;
+}
+
+statement& statement::bind(unsigned int index, const std::string& value)  
+{
+    ensure(_params, index)[index] = value;
+    // TODO process error, throw exception
+    return *this;
+}
+
+statement& statement::bind(unsigned int index, const std::string_view& value)  
+{
+    ensure(_params, index)[index] = std::string(value);
+    // TODO process error, throw exception
+    return *this;
+}
+
+statement& statement::bind(unsigned int index, const blob& value)  
+{
+    ensure(_params, index)[index] = value;
+    // TODO process error, throw exception
+    return *this;
+}
+
+statement& statement::bind(unsigned int index, bool value)
+{
+    ensure(_params, index)[index] = value;
+    // TODO process error, throw exception
+    return *this;
+}
+
+statement& statement::bind(unsigned int index, int value)
+{
+    ensure(_params, index)[index] = value;
+    // TODO process error, throw exception
+    return *this;
+}
+
+statement& statement::bind(unsigned int index, int64_t value)  
+{
+    ensure(_params, index)[index] = value;
+    // TODO process error, throw exception
+    return *this;
+}
+
+statement& statement::bind(unsigned int index, double value)  
+{
+    ensure(_params, index)[index] = value;
+    // TODO process error, throw exception
+    return *this;
+}
+
+statement& statement::bind(unsigned int index, const value& value)  
+{
+    std::visit([&](auto&& arg) {
+        bind(index, arg);
+    }, value);
+    return *this;
+}
+
+//
+// PostgreSQL's pipeline
+//
+
+pipeline::pipeline(std::shared_ptr<PGconn> db, unsigned int max_pending) :
+    _db(std::move(db)),
+    _max_pending(max_pending > 0 ? max_pending : 1)
+{
+#ifdef LIBPQ_HAS_PIPELINING
+    if(!PQenterPipelineMode(_db.get())) {
+        std::cerr << "Failed to enter pipeline mode: " << PQerrorMessage(_db.get()) << std::endl;
+        // TODO throw exception
+    }
+#endif
+}
+
+pipeline::~pipeline()
+{
+#ifdef LIBPQ_HAS_PIPELINING
+    process_pending();
+    PQexitPipelineMode(_db.get());
+#endif
+}
+
+pipeline& pipeline::execute(sqlcpp::statement& stmt)
+{
+    auto* pg_stmt = dynamic_cast<statement*>(&stmt);
+    if(pg_stmt == nullptr) {
+        std::cerr << "Only PostgreSQL statements can be pipelined" << std::endl;
+        // TODO throw exception
+        process_pending();
+        _results.push_back(nullptr);
+        return *this;
+    }
+
+#ifdef LIBPQ_HAS_PIPELINING
+    if(!pg_stmt->send_query()) {
+        process_pending();
+        _results.push_back(nullptr);
+    } else if(++_pending >= _max_pending) {
+        process_pending();
+    }
+#else
+    // No pipelining support in libpq, execute it right now
+    PGresult* res = pg_stmt->execute_prepared();
+    ExecStatusType type = PQresultStatus(res);
+    _results.push_back(type == PGRES_COMMAND_OK || type == PGRES_TUPLES_OK ? helpers::get_stats(res) : nullptr);
+    PQclear(res);
+#endif
+    return *this;
+}
+
+void pipeline::process_pending()
+{
+#ifdef LIBPQ_HAS_PIPELINING
+    if(_pending == 0) {
+        return;
+    }
+    PGconn* db = _db.get();
+    if(!PQpipelineSync(db)) {
+        std::cerr << "Failed to synchronize pipeline: " << PQerrorMessage(db) << std::endl;
+        // TODO throw exception
+    }
+    for(unsigned int i=0; i<_pending; ++i) {
+        PGresult* res = PQgetResult(db);
+        switch(PQresultStatus(res)) {
+            case PGRES_COMMAND_OK:
+            case PGRES_TUPLES_OK:
+                _results.push_back(helpers::get_stats(res));
+                break;
+            case PGRES_PIPELINE_ABORTED:
+                // A previous statement failed, this one has not been executed
+                _results.push_back(nullptr);
+                break;
+            default:
+                std::cerr << "Failed to execute pipelined statement: " << PQresultErrorMessage(res) << std::endl;
+                // TODO throw exception
+                _results.push_back(nullptr);
+                break;
+        }
+        PQclear(res);
+        // Each statement results are terminated by a null result
+        helpers::drain_results(db);
+    }
+    PGresult* res = PQgetResult(db);
+    if(PQresultStatus(res) != PGRES_PIPELINE_SYNC) {
+        std::cerr << "Unexpected pipeline result: " << PQresStatus(PQresultStatus(res)) << std::endl;
+    }
+    PQclear(res);
+    _pending = 0;
+#endif
+}
+
+std::vector<std::shared_ptr<stats_result>> pipeline::sync()
+{
+    process_pending();
+    std::vector<std::shared_ptr<stats_result>> results;
+    results.swap(_results);
+    return results;
+}
+
+//
+// PostgreSQL's copy writer
+//
+
+// Binary COPY signature, followed by flags and header extension length
+static const char copy_binary_signature[] = "PGCOPY\n\377\r\n";
+
+copy_writer::copy_writer(std::shared_ptr<PGconn> db, std::vector<Oid> types, bool binary, size_t buffer_size) :
+    _db(std::move(db)),
+    _types(std::move(types)),
+    _binary(binary),
+    _buffer_size(buffer_size)
+{
+    _buffer.reserve(_buffer_size);
+    if(_binary) {
+        _buffer.append(copy_binary_signature, sizeof(copy_binary_signature));
+        char header[8];
+        helpers::write_int32(header, 0);
+        helpers::write_int32(header + 4, 0);
+        _buffer.append(header, sizeof(header));
+    }
+}
+
+copy_writer::~copy_writer()
+{
+    if(_active) {
+        PQputCopyEnd(_db.get(), "copy aborted by client");
+        helpers::drain_results(_db.get());
+    }
+}
+
+bool copy_writer::binary() const
+{
+    return _binary;
+}
+
+void copy_writer::begin_row()
+{
+    _row_start = _buffer.size();
+    _field = 0;
+    _row_error = false;
+    if(_binary) {
+        char count[2];
+        helpers::write_int16(count, (int16_t) _types.size());
+        _buffer.append(count, sizeof(count));
+    }
+}
+
+void copy_writer::end_row()
+{
+    if(_field != _types.size()) {
+        std::cerr << "Failed to write COPY row: " << _field << " values for " << _types.size() << " columns" << std::endl;
+        _row_error = true;
+    }
+    if(_row_error || !_active) {
+        // TODO throw exception
+        _buffer.resize(_row_start);
+        return;
+    }
+    if(!_binary) {
+        _buffer.push_back('\n');
+    }
+    ++_rows;
+    if(_buffer.size() >= _buffer_size) {
+        flush();
+    }
+}
+
+Oid copy_writer::current_type() const
+{
+    return _field < _types.size() ? _types[_field] : InvalidOid;
+}
+
+Oid copy_writer::next_field()
+{
+    if(!_binary && _field > 0) {
+        _buffer.push_back('\t');
+    }
+    return _field < _types.size() ? _types[_field++] : (++_field, InvalidOid);
+}
+
+void copy_writer::invalid_field(Oid oid)
+{
+    if(oid != InvalidOid) {
+        std::cerr << "Failed to write COPY row: invalid value for column " << _field << std::endl;
+    }
+    _row_error = true;
+}
+
+void copy_writer::append_binary(const char* data, size_t size)
+{
+    char length[4];
+    helpers::write_int32(length, (int32_t) size);
+    _buffer.append(length, sizeof(length));
+    _buffer.append(data, size);
+}
+
+void copy_writer::append_text(std::string_view str)
+{
+    // Escape backslashes and delimiters
+    size_t pos = 0;
+    while(pos < str.size()) {
+        size_t next = str.find_first_of("\\\t\n\r", pos);
+        if(next == std::string_view::npos) {
+            _buffer.append(str.data() + pos, str.size() - pos);
+            break;
+        }
+        _buffer.append(str.data() + pos, next - pos);
+        _buffer.push_back('\\');
+        switch(str[next]) {
+            case '\t': _buffer.push_back('t'); break;
+            case '\n': _buffer.push_back('n'); break;
+            case '\r': _buffer.push_back('r'); break;
+            default: _buffer.push_back('\\'); break;
+        }
+        pos = next + 1;
+    }
+}
+
+bool copy_writer::flush()
+{
+    if(_buffer.empty()) {
+        return true;
+    }
+    if(PQputCopyData(_db.get(), _buffer.data(), _buffer.size()) != 1) {
+        std::cerr << "Failed to send COPY data: " << PQerrorMessage(_db.get()) << std::endl;
+        // TODO throw exception
+        _buffer.clear();
+        return false;
+    }
+    _buffer.clear();
+    return true;
+}
+
+void copy_writer::add_field(std::nullptr_t)
+{
+    next_field();
+    if(_binary) {
+        char length[4];
+        helpers::write_int32(length, -1);
+        _buffer.append(length, sizeof(length));
+    } else {
+        _buffer.append("\\N");
+    }
+}
+
+void copy_writer::add_field(std::string_view value)
+{
+    Oid oid = current_type();
+    if(_binary && oid == BOOLOID) {
+        add_field(to_bool(std::string(value)));
+    } else if(_binary && (oid == INT2OID || oid == INT4OID || oid == INT8OID || oid == FLOAT4OID || oid == FLOAT8OID)) {
+        // Numbers are parsed from their text representation
+        try {
+            if(oid == FLOAT4OID || oid == FLOAT8OID) {
+                add_field(std::stod(std::string(value)));
+            } else {
+                add_field((int64_t) std::stoll(std::string(value)));
+            }
+        } catch(const std::exception&) {
+            invalid_field(next_field());
+        }
+    } else if(_binary) {
+        next_field();
+        append_binary(value.data(), value.size());
+    } else {
+        next_field();
+        append_text(value);
+    }
+}
+
+void copy_writer::add_field(const std::string& value)
+{
+    add_field(std::string_view(value));
+}
+
+void copy_writer::add_field(const char* value)
+{
+    add_field(std::string_view(value));
+}
+
+void copy_writer::add_field(const blob& value)
+{
+    Oid oid = next_field();
+    if(_binary) {
+        if(oid == BYTEAOID || helpers::column_type_from_oid(oid) == value_type::STRING) {
+            append_binary(reinterpret_cast<const char*>(value.data()), value.size());
+        } else {
+            invalid_field(oid);
+        }
+    } else {
+        // Hex format, with its backslash escaped
+        size_t pos = _buffer.size();
+        _buffer.resize(pos + 3 + value.size() * 2);
+        _buffer[pos++] = '\\';
+        _buffer[pos++] = '\\';
+        _buffer[pos++] = 'x';
+        details::hex_encode(value, &_buffer[pos]);
+    }
+}
+
+void copy_writer::add_field(bool value)
+{
+    if(_binary && current_type() != BOOLOID) {
+        add_field((int64_t) (value ? 1 : 0));
+        return;
+    }
+    next_field();
+    if(_binary) {
+        char val = value ? 1 : 0;
+        append_binary(&val, 1);
+    } else {
+        _buffer.push_back(value ? 't' : 'f');
+    }
+}
+
+void copy_writer::add_field(int value)
+{
+    add_field((int64_t) value);
+}
+
+void copy_writer::add_field(int64_t value)
+{
+    Oid oid = next_field();
+    if(!_binary) {
+        _buffer.append(std::to_string(value));
+        return;
+    }
+    char buffer[8];
+    switch(oid) {
+        case INT8OID:
+            helpers::write_int64(buffer, value);
+            append_binary(buffer, 8);
+            break;
+        case INT4OID:
+            if(value < std::numeric_limits<int32_t>::min() || value > std::numeric_limits<int32_t>::max()) {
+                invalid_field(oid);
+                break;
+            }
+            helpers::write_int32(buffer, (int32_t) value);
+            append_binary(buffer, 4);
+            break;
+        case INT2OID:
+            if(value < std::numeric_limits<int16_t>::min() || value > std::numeric_limits<int16_t>::max()) {
+                invalid_field(oid);
+                break;
+            }
+            helpers::write_int16(buffer, (int16_t) value);
+            append_binary(buffer, 2);
+            break;
+        case FLOAT8OID:
+            helpers::write_float8(buffer, (double) value);
+            append_binary(buffer, 8);
+            break;
+        case FLOAT4OID:
+            helpers::write_float4(buffer, (float) value);
+            append_binary(buffer, 4);
+            break;
+        case BOOLOID:
+            buffer[0] = value != 0 ? 1 : 0;
+            append_binary(buffer, 1);
+            break;
+        default:
+            if(helpers::column_type_from_oid(oid) == value_type::STRING) {
+                std::string str = std::to_string(value);
+                append_binary(str.data(), str.size());
+            } else {
+                invalid_field(oid);
+            }
+            break;
+    }
+}
+
+void copy_writer::add_field(double value)
+{
+    Oid oid = current_type();
+    if(_binary && (oid == INT2OID || oid == INT4OID || oid == INT8OID || oid == BOOLOID)) {
+        if(value >= -9.2e18 && value <= 9.2e18) {
+            add_field((int64_t) value);
+        } else {
+            invalid_field(next_field());
+        }
+        return;
+    }
+    next_field();
+    char buffer[32];
+    if(!_binary || helpers::column_type_from_oid(oid) == value_type::STRING) {
+        // Enough digits to round-trip
+        int size = std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+        if(_binary) {
+            append_binary(buffer, size);
+        } else {
+            _buffer.append(buffer, size);
+        }
+        return;
+    }
+    switch(oid) {
+        case FLOAT8OID:
+            helpers::write_float8(buffer, value);
+            append_binary(buffer, 8);
+            break;
+        case FLOAT4OID:
+            helpers::write_float4(buffer, (float) value);
+            append_binary(buffer, 4);
+            break;
+        default:
+            invalid_field(oid);
+            break;
+    }
+}
+
+void copy_writer::add_field(const value& value)
+{
+    std::visit([&](auto&& arg) {
+        using T = std::decay_t<decltype(arg)>;
+        if constexpr(std::is_same_v<T, std::monostate>) {
+            add_field(nullptr);
+        } else {
+            add_field(arg);
+        }
+    }, value);
+}
+
+copy_writer& copy_writer::write_row(const std::vector<value>& values)
+{
+    begin_row();
+    for(const auto& val : values) {
+        add_field(val);
+    }
+    end_row();
+    return *this;
+}
+
+copy_writer& copy_writer::write_row(std::initializer_list<value> values)
+{
+    begin_row();
+    for(const auto& val : values) {
+        add_field(val);
+    }
+    end_row();
+    return *this;
+}
+
+std::shared_ptr<stats_result> copy_writer::finish()
+{
+    if(!_active) {
+        return {};
+    }
+    _active = false;
+
+    PGconn* db = _db.get();
+    if(_binary) {
+        // File trailer
+        char trailer[2];
+        helpers::write_int16(trailer, -1);
+        _buffer.append(trailer, sizeof(trailer));
+    }
+    bool sent = flush();
+    if(PQputCopyEnd(db, sent ? nullptr : "failed to send data") != 1) {
+        std::cerr << "Failed to end COPY: " << PQerrorMessage(db) << std::endl;
+    }
+
+    std::shared_ptr<stats_result> stats;
+    PGresult* res = PQgetResult(db);
+    if(PQresultStatus(res) == PGRES_COMMAND_OK) {
+        stats = helpers::get_stats(res);
+    } else {
+        std::cerr << "Failed to execute COPY: " << PQresultErrorMessage(res) << std::endl;
+        // TODO throw exception
     }
+    PQclear(res);
+    helpers::drain_results(db);
+    return stats;
 }
 
-std::shared_ptr<sqlcpp::buffered_resultset> statement::execute_buffered()
+//
+// PostgreSQL's copy reader
+//
+
+// Row view over a data row received from COPY ... TO STDOUT, valid until the next row is parsed
+class copy_row : public row_base
 {
-    PGresult *res = execute_prepared();
-    // TODO support binary format for slight better performances
-    switch(PQresultStatus(res)) {
-        case PGRES_COMMAND_OK:
-        case PGRES_TUPLES_OK: {
-            auto buff = std::make_shared<details::generic_buffered_resultset>();
+protected:
+    std::vector<Oid> _types;
+    bool _binary;
+    bool _header_done = false;
+    std::vector<const char*> _values;
+    std::vector<int> _lengths;
+    // Decoded text BYTEA values for views, by column
+    mutable std::vector<blob> _buffers;
+
+    bool parse_binary(char* data, int size);
+    std::string_view get_view(unsigned int index) const;
+    bool parse_text(char* data, int size);
 
-            std::string affected_rows_str = PQcmdTuples(res);
-            unsigned long long affected_rows = affected_rows_str.empty() ? 0 : std::stoull(affected_rows_str);
-            unsigned long long last_insert_id = PQoidValue(res);
+public:
+    copy_row(std::vector<Oid> types, bool binary) :
+        _types(std::move(types)), _binary(binary),
+        _values(_types.size(), nullptr), _lengths(_types.size(), -1)
+    {}
 
-            int col_count = PQnfields(res);
-            for (int index = 0; index < col_count; ++index) {
-                std::string col_name = PQfname(res, index);
-                value_type col_type = helpers::column_type_from_oid(PQftype(res, index));
-                std::string column_origin_name; // TODO not supported directly by PGSQL
-                std::string table_origin_name; // TODO not supported directly by PGSQL
-                buff->add_column(col_name, col_type, column_origin_name, table_origin_name);
-            }
+    // Parse a data buffer, modified in place, return true if it holds a row
+    bool parse(char* data, int size);
 
-            int row_count = PQntuples(res);
-            for (int row_index = 0; row_index < row_count; ++row_index) {
-                details::generic_row row;
-                for (int col_index = 0; col_index < col_count; ++col_index) {
-                    row.add_value(helpers::get_value(res, row_index, col_index));
-                }
-                buff->add_row(std::move(row));
-            }
-            PQclear(res);
-            return buff;
+    size_t size() const override;
+
+    value get_value(unsigned int index) const override;
+
+    std::string get_value_string(unsigned int index) const override;
+    blob get_value_blob(unsigned int index) const override;
+    bool get_value_bool(unsigned int index) const override;
+    int get_value_int(unsigned int index) const override;
+    int64_t get_value_int64(unsigned int index) const override;
+    double get_value_double(unsigned int index) const override;
+    std::string_view get_value_string_view(unsigned int index) const override;
+    blob_span get_value_blob_span(unsigned int index) const override;
+    size_t value_size(unsigned int index) const override;
+};
+
+bool copy_row::parse(char* data, int size)
+{
+    return _binary ? parse_binary(data, size) : parse_text(data, size);
+}
+
+bool copy_row::parse_binary(char* data, int size)
+{
+    const char* end = data + size;
+    if(!_header_done) {
+        // Signature, flags and header extension, may share its buffer with the first row
+        if(size < (int) sizeof(copy_binary_signature) + 8 || std::memcmp(data, copy_binary_signature, sizeof(copy_binary_signature)) != 0) {
+            std::cerr << "Invalid binary COPY header" << std::endl;
+            return false;
         }
-        default:
-            std::cerr << "Failed to execute statement: " << PQerrorMessage(_db.lock().get()) << std::endl;
-            PQclear(res);
-            // TODO throw exception
-            return {};
+        data += sizeof(copy_binary_signature) + 4;
+        int32_t extension = helpers::read_int32(data);
+        data += 4;
+        if(extension < 0 || extension > end - data) {
+            std::cerr << "Invalid binary COPY header" << std::endl;
+            return false;
+        }
+        data += extension;
+        _header_done = true;
     }
-
-    return {};
+    if(end - data < 2) {
+        return false;
+    }
+    int16_t count = helpers::read_int16(data);
+    data += 2;
+    if(count < 0) {
+        // Trailer
+        return false;
+    }
+    if((size_t) count != _types.size()) {
+        std::cerr << "Unexpected binary COPY field count: " << count << std::endl;
+        return false;
+    }
+    for(size_t index = 0; index < _types.size(); ++index) {
+        if(end - data < 4) {
+            std::cerr << "Truncated binary COPY row" << std::endl;
+            return false;
+        }
+        int32_t length = helpers::read_int32(data);
+        data += 4;
+        if(length > end - data) {
+            std::cerr << "Truncated binary COPY row" << std::endl;
+            return false;
+        }
+        _values[index] = data;
+        _lengths[index] = length;
+        if(length > 0) {
+            data += length;
+        }
+    }
+    return true;
 }
 
-unsigned int statement::parameter_count() const
+bool copy_row::parse_text(char* data, int size)
 {
-    if(!_stmt_info) {
-        PGresult* res = PQdescribePrepared(_db.lock().get(), _stmt_name.c_str());
-        if(PQresultStatus(_stmt_info.get()) != PGRES_COMMAND_OK) {
-            // TODO process error, throw exception
-            return 0;
+    // Fields are split on tabulations, unescaped and null-terminated in place
+    // (buffers returned by PQgetCopyData() are null-terminated, so the last field can be terminated too)
+    char* end = data + size;
+    if(size > 0 && end[-1] == '\n') {
+        --end;
+    }
+    char* in = data;
+    for(size_t index = 0; index < _types.size(); ++index) {
+        if(in > end) {
+            std::cerr << "Truncated text COPY row" << std::endl;
+            return false;
         }
-        _stmt_info = std::shared_ptr<PGresult>(res , PQclear);
+        if(end - in >= 2 && in[0] == '\\' && in[1] == 'N' && (in + 2 == end || in[2] == '\t')) {
+            // Null marker
+            _values[index] = in;
+            _lengths[index] = -1;
+            in += 3;
+            continue;
+        }
+        char* start = in;
+        char* out = in;
+        while(in < end && *in != '\t') {
+            if(*in != '\\' || in + 1 >= end) {
+                *out++ = *in++;
+                continue;
+            }
+            char c = in[1];
+            in += 2;
+            switch(c) {
+                case 'b': *out++ = '\b'; break;
+                case 'f': *out++ = '\f'; break;
+                case 'n': *out++ = '\n'; break;
+                case 'r': *out++ = '\r'; break;
+                case 't': *out++ = '\t'; break;
+                case 'v': *out++ = '\v'; break;
+                default:
+                    if(c >= '0' && c <= '7') {
+                        int val = c - '0';
+                        for(int i=0; i<2 && in < end && *in >= '0' && *in <= '7'; ++i) {
+                            val = (val << 3) | (*in++ - '0');
+                        }
+                        *out++ = (char) val;
+                    } else {
+                        *out++ = c;
+                    }
+                    break;
+            }
+        }
+        // The terminator may overwrite the separator, skip it first
+        ++in;
+        *out = '\0';
+        _values[index] = start;
+        _lengths[index] = (int) (out - start);
     }
-    return PQnparams(_stmt_info.get());
+    return true;
 }
 
-int statement::parameter_index(const std::string& name) const 
+size_t copy_row::size() const
 {
-    // Parameter names not supported for PostgreSQL yet
-    // TODO
-    return -1;
+    return _types.size();
 }
 
-std::string statement::parameter_name(unsigned int index) const 
+value copy_row::get_value(unsigned int index) const
 {
-    // Parameter names not supported for PostgreSQL yet
-    // TODO
-    return "";
+    if(_lengths[index] < 0) {
+        return {nullptr};
+    }
+    return helpers::get_value(_types[index], _binary, _values[index], _lengths[index]);
 }
 
-statement& statement::bind(const std::string& name, std::nullptr_t) 
+std::string copy_row::get_value_string(unsigned int index) const
 {
-    // Parameter names not supported for PostgreSQL yet
-    // TODO
-    return *this;
+    if(_lengths[index] < 0) {
+        return "NULL";
+    }
+    return helpers::get_string(_types[index], _binary, _values[index], _lengths[index]);
 }
 
-statement& statement::bind(const std::string& name, const std::string& value)
+blob copy_row::get_value_blob(unsigned int index) const
 {
-    // Parameter names not supported for PostgreSQL yet
-    // TODO
-    return *this;
+    if(_lengths[index] < 0) {
+        return {};
+    }
+    return helpers::get_blob(_types[index], _binary, _values[index], _lengths[index]);
 }
 
-statement& statement::bind(const std::string& name, const std::string_view& value)
+bool copy_row::get_value_bool(unsigned int index) const
 {
-    // Parameter names not supported for PostgreSQL yet
-    // TODO
-    return *this;
+    if(_lengths[index] < 0) {
+        return false;
+    }
+    return helpers::get_bool(_types[index], _binary, _values[index], _lengths[index]);
 }
 
-statement& statement::bind(const std::string& name, const blob& value) 
+int copy_row::get_value_int(unsigned int index) const
 {
-    // Parameter names not supported for PostgreSQL yet
-    // TODO
-    return *this;
+    if(_lengths[index] < 0) {
+        return 0;
+    }
+    return (int) helpers::get_int64(_types[index], _binary, _values[index], _lengths[index]);
 }
 
-statement& statement::bind(const std::string& name, bool value)
+int64_t copy_row::get_value_int64(unsigned int index) const
 {
-    // Parameter names not supported for PostgreSQL yet
-    // TODO
-    return *this;
+    if(_lengths[index] < 0) {
+        return 0;
+    }
+    return helpers::get_int64(_types[index], _binary, _values[index], _lengths[index]);
 }
 
-statement& statement::bind(const std::string& name, int value)
+double copy_row::get_value_double(unsigned int index) const
 {
-    // Parameter names not supported for PostgreSQL yet
-    // TODO
-    return *this;
+    if(_lengths[index] < 0) {
+        return 0;
+    }
+    return helpers::get_double(_types[index], _binary, _values[index], _lengths[index]);
 }
 
-statement& statement::bind(const std::string& name, int64_t value)  
+std::string_view copy_row::get_view(unsigned int index) const
 {
-    // Parameter names not supported for PostgreSQL yet
-    // TODO
-    return *this;
+    if(_lengths[index] < 0) {
+        return {};
+    }
+    if(_buffers.size() <= index) {
+        _buffers.resize(index + 1);
+    }
+    return helpers::get_view(_types[index], _binary, _values[index], _lengths[index], _buffers[index]);
 }
 
-statement& statement::bind(const std::string& name, double value)  
+std::string_view copy_row::get_value_string_view(unsigned int index) const
 {
-    // Parameter names not supported for PostgreSQL yet
-    // TODO
-    return *this;
+    return get_view(index);
 }
 
-statement& statement::bind(const std::string& name, const value& value)  
+blob_span copy_row::get_value_blob_span(unsigned int index) const
 {
-    // Parameter names not supported for PostgreSQL yet
-    // TODO
-//    std::visit([&](auto&& arg) {
-//        bind(name, arg);
-//    }, value);
-    return *this;
+    std::string_view data = get_view(index);
+    return {reinterpret_cast<const unsigned char*>(data.data()), data.size()};
 }
 
-static inline std::vector<value>& ensure(std::vector<value>& params, unsigned int index)
+size_t copy_row::value_size(unsigned int index) const
 {
-    if(params.size() <= index) {
-        params.resize(index + 1);
+    if(_lengths[index] < 0) {
+        return 0;
     }
-    return params;
+    return helpers::value_size(_types[index], _lengths[index]);
 }
 
+//
+// PostgreSQL's connection
+//
 
-statement& statement::bind(unsigned int index, std::nullptr_t)  
+connection::connection(PGconn* db):
+_db(db, &PQfinish)
 {
-    ensure(_params, index)[index] = nullptr;
-    // TODO process error, throw exception
-    return *this;
 }
 
-statement& statement::bind(unsigned int index, const std::string& value)  
+connection::~connection()
 {
-    ensure(_params, index)[index] = value;
-    // TODO process error, throw exception
-    return *this;
+    clear_statement_cache();
 }
 
-statement& statement::bind(unsigned int index, const std::string_view& value)  
+bool connection::binary_results() const
 {
-    ensure(_params, index)[index] = std::string(value);
-    // TODO process error, throw exception
-    return *this;
+    return _binary_results;
 }
 
-statement& statement::bind(unsigned int index, const blob& value)  
+void connection::binary_results(bool binary)
 {
-    ensure(_params, index)[index] = value;
-    // TODO process error, throw exception
-    return *this;
+    // Cached statements keep the format they were prepared with
+    if(binary != _binary_results) {
+        clear_statement_cache();
+    }
+    _binary_results = binary;
 }
 
-statement& statement::bind(unsigned int index, bool value)
+bool connection::binary_parameters() const
 {
-    ensure(_params, index)[index] = value;
-    // TODO process error, throw exception
-    return *this;
+    return _binary_parameters;
 }
 
-statement& statement::bind(unsigned int index, int value)
+void connection::binary_parameters(bool binary)
 {
-    ensure(_params, index)[index] = value;
-    // TODO process error, throw exception
-    return *this;
+    // Cached statements keep the format they were prepared with
+    if(binary != _binary_parameters) {
+        clear_statement_cache();
+    }
+    _binary_parameters = binary;
 }
 
-statement& statement::bind(unsigned int index, int64_t value)  
+std::shared_ptr<pipeline> connection::start_pipeline(unsigned int max_pending)
 {
-    ensure(_params, index)[index] = value;
-    // TODO process error, throw exception
-    return *this;
+    return std::make_shared<pipeline>(_db, max_pending);
 }
 
-statement& statement::bind(unsigned int index, double value)  
+std::shared_ptr<copy_writer> connection::copy_from(const std::string& table, const std::vector<std::string>& columns, size_t buffer_size)
 {
-    ensure(_params, index)[index] = value;
-    // TODO process error, throw exception
-    return *this;
+    std::string column_list;
+    for(const auto& column : columns) {
+        if(!column_list.empty()) {
+            column_list += ", ";
+        }
+        column_list += column;
+    }
+
+    // Retrieve column types, binary COPY requires values in the exact column type representation
+    std::string describe = "SELECT " + (column_list.empty() ? std::string("*") : column_list) + " FROM " + table + " LIMIT 0";
+    PGresult* res = PQexec(_db.get(), describe.c_str());
+    if(PQresultStatus(res) != PGRES_TUPLES_OK) {
+        std::cerr << "Failed to describe COPY columns: " << PQerrorMessage(_db.get()) << std::endl;
+        PQclear(res);
+        // TODO throw exception
+        return {};
+    }
+    std::vector<Oid> types;
+    bool binary = true;
+    for(int index = 0; index < PQnfields(res); ++index) {
+        Oid oid = PQftype(res, index);
+        types.push_back(oid);
+        // "char" is a single byte in binary format, keep it out
+        binary &= oid != CHAROID && helpers::column_type_from_oid(oid) != value_type::UNSUPPORTED;
+    }
+    PQclear(res);
+
+    std::string query = "COPY " + table + (column_list.empty() ? std::string() : " (" + column_list + ")") + " FROM STDIN";
+    if(binary) {
+        query += " WITH (FORMAT binary)";
+    }
+    res = PQexec(_db.get(), query.c_str());
+    if(PQresultStatus(res) != PGRES_COPY_IN) {
+        std::cerr << "Failed to start COPY: " << PQerrorMessage(_db.get()) << std::endl;
+        PQclear(res);
+        // TODO throw exception
+        return {};
+    }
+    PQclear(res);
+    return std::make_shared<copy_writer>(_db, std::move(types), binary, buffer_size);
 }
 
-statement& statement::bind(unsigned int index, const value& value)  
+std::shared_ptr<stats_result> connection::copy_to(const std::string& query, std::function<void(const row_base&)> func)
 {
-    std::visit([&](auto&& arg) {
-        bind(index, arg);
-    }, value);
-    return *this;
-}
+    PGconn* db = _db.get();
 
-//
-// PostgreSQL's connection
-//
+    // Describe the query with the unnamed statement to get column types
+    PGresult* res = PQprepare(db, "", query.c_str(), 0, nullptr);
+    if(PQresultStatus(res) != PGRES_COMMAND_OK) {
+        std::cerr << "Failed to describe COPY query: " << PQerrorMessage(db) << std::endl;
+        PQclear(res);
+        // TODO throw exception
+        return {};
+    }
+    PQclear(res);
+    res = PQdescribePrepared(db, "");
+    if(PQresultStatus(res) != PGRES_COMMAND_OK) {
+        std::cerr << "Failed to describe COPY query: " << PQerrorMessage(db) << std::endl;
+        PQclear(res);
+        // TODO throw exception
+        return {};
+    }
+    std::vector<Oid> types;
+    bool binary = true;
+    for(int index = 0; index < PQnfields(res); ++index) {
+        Oid oid = PQftype(res, index);
+        types.push_back(oid);
+        binary &= oid != CHAROID && helpers::column_type_from_oid(oid) != value_type::UNSUPPORTED;
+    }
+    PQclear(res);
 
-connection::connection(PGconn* db):
-_db(db, &PQfinish)
+    std::string copy = "COPY (" + query + ") TO STDOUT";
+    if(binary) {
+        copy += " WITH (FORMAT binary)";
+    }
+    res = PQexec(db, copy.c_str());
+    if(PQresultStatus(res) != PGRES_COPY_OUT) {
+        std::cerr << "Failed to start COPY: " << PQerrorMessage(db) << std::endl;
+        PQclear(res);
+        // TODO throw exception
+        return {};
+    }
+    PQclear(res);
+
+    copy_row row(std::move(types), binary);
+    char* buffer = nullptr;
+    int size;
+    try {
+        while((size = PQgetCopyData(db, &buffer, 0)) > 0) {
+            std::unique_ptr<char, void(*)(void*)> guard(buffer, PQfreemem);
+            if(row.parse(buffer, size)) {
+                func(row);
+            }
+        }
+    } catch(...) {
+        // Cancel the copy and flush remaining data to release the connection
+        helpers::cancel_query(db);
+        while((size = PQgetCopyData(db, &buffer, 0)) > 0) {
+            PQfreemem(buffer);
+        }
+        helpers::drain_results(db);
+        throw;
+    }
+    if(size == -2) {
+        std::cerr << "Failed to receive COPY data: " << PQerrorMessage(db) << std::endl;
+    }
+
+    std::shared_ptr<stats_result> stats;
+    res = PQgetResult(db);
+    if(PQresultStatus(res) == PGRES_COMMAND_OK) {
+        stats = helpers::get_stats(res);
+    } else {
+        std::cerr << "Failed to execute COPY: " << PQresultErrorMessage(res) << std::endl;
+        // TODO throw exception
+    }
+    PQclear(res);
+    helpers::drain_results(db);
+    return stats;
+}
+
+unsigned int connection::streaming_rows() const
 {
+    return _streaming_rows;
 }
 
-connection::~connection()
+void connection::streaming_rows(unsigned int chunk_size)
 {
+    // Cached statements keep the streaming mode they were prepared with
+    if(chunk_size != _streaming_rows) {
+        clear_statement_cache();
+    }
+    _streaming_rows = chunk_size;
 }
 
 std::shared_ptr<connection> connection::create(const std::string& connection_string)
@@ -917,15 +2511,17 @@ std::shared_ptr<stats_result> connection::execute(const std::string& query)
 {
     char* err_msg = nullptr;
 
+    std::shared_ptr<details::query_observation> observation = observe(query);
     PGresult* res = PQexec(_db.get(), query.c_str());
     switch(PQresultStatus(res)) {
         case PGRES_COMMAND_OK:
         case PGRES_TUPLES_OK: {
-            std::string str = PQcmdTuples(res);
-            unsigned long long affected_rows = !str.empty() ? std::stoull(str) : 0;
-            Oid last_inserted = PQoidValue(res);
+            if(observation) {
+                observation->executed(false);
+            }
+            auto stats = helpers::get_stats(res);
             PQclear(res);
-            return std::make_shared<details::simple_stats_result>(affected_rows, last_inserted);
+            return stats;
         }
         default:
             std::cerr << "Failed to execute statement: " << PQerrorMessage(_db.get()) << std::endl;
@@ -935,17 +2531,34 @@ std::shared_ptr<stats_result> connection::execute(const std::string& query)
     }
 }
 
+bool connection::is_valid()
+{
+    if (PQstatus(_db.get()) != CONNECTION_OK) {
+        return false;
+    }
+    PGresult* res = PQexec(_db.get(), "");
+    bool valid = PQresultStatus(res) == PGRES_EMPTY_QUERY;
+    PQclear(res);
+    return valid && PQstatus(_db.get()) == CONNECTION_OK;
+}
+
 std::shared_ptr<sqlcpp::statement> connection::prepare(const std::string& query)
 {
+    std::shared_ptr<details::query_observation> observation = observe(query);
     static unsigned int count = 0;
     std::ostringstream oss;
     oss << "prepared-" << count++;
     std::string stmt_name = oss.str(); // TODO Generate a unique statement name
     PGresult* res = PQprepare(_db.get(), stmt_name.c_str(), query.c_str(), 0, nullptr);
     switch(PQresultStatus(res)) {
-        case PGRES_COMMAND_OK:
+        case PGRES_COMMAND_OK: {
             PQclear(res);
-            return std::make_shared<statement>(_db, stmt_name);
+            auto stmt = std::make_shared<statement>(_db, stmt_name, _binary_results, _binary_parameters, _streaming_rows);
+            if(observation) {
+                observation->prepared(*stmt);
+            }
+            return stmt;
+        }
         default:
             std::cerr << "Failed to prepare statement: " << PQerrorMessage(_db.get()) << std::endl;
             PQclear(res);
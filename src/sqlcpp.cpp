@@ -21,6 +21,7 @@
 
 #include "sqlcpp_config.hpp"
 
+#include <cstring>
 #include <filesystem>
 #include <stdexcept>
 #include <iostream>
@@ -138,21 +139,134 @@ std::shared_ptr<connection> connection::create(const std::string& connection_str
     return details::connection_factory_registry::get().create_connection(connection_string);
 }
 
+bool connection::is_valid()
+{
+    return true;
+}
+
+std::shared_ptr<statement> connection::prepare_cached(const std::string& query)
+{
+    if (_statement_cache_capacity == 0) {
+        return prepare(query);
+    }
+
+    if (auto it = _statement_cache_index.find(query); it != _statement_cache_index.end()) {
+        std::shared_ptr<details::query_observation> observation = observe(query);
+        _statement_cache.splice(_statement_cache.begin(), _statement_cache, it->second);
+        std::shared_ptr<statement> stmt = it->second->second;
+        stmt->reset();
+        if (observation) {
+            observation->prepared(*stmt, true);
+        }
+        return stmt;
+    }
+
+    std::shared_ptr<statement> stmt = prepare(query);
+    if (!stmt) {
+        return {};
+    }
+    _statement_cache.emplace_front(query, stmt);
+    _statement_cache_index[query] = _statement_cache.begin();
+    statement_cache_capacity(_statement_cache_capacity);
+    return stmt;
+}
+
+size_t connection::statement_cache_capacity() const
+{
+    return _statement_cache_capacity;
+}
+
+void connection::statement_cache_capacity(size_t capacity)
+{
+    _statement_cache_capacity = capacity;
+    while (_statement_cache.size() > _statement_cache_capacity) {
+        _statement_cache_index.erase(_statement_cache.back().first);
+        _statement_cache.pop_back();
+    }
+}
+
+size_t connection::statement_cache_size() const
+{
+    return _statement_cache.size();
+}
+
+void connection::clear_statement_cache()
+{
+    _statement_cache_index.clear();
+    _statement_cache.clear();
+}
+
+std::shared_ptr<connection_observer> connection::observer() const
+{
+    return _observer;
+}
+
+void connection::observer(std::shared_ptr<connection_observer> observer)
+{
+    // Cached statements keep the observer they were prepared with
+    if (observer != _observer) {
+        clear_statement_cache();
+    }
+    _observer = std::move(observer);
+}
+
+std::shared_ptr<details::query_observation> connection::observe(const std::string& query) const
+{
+    return _observer ? std::make_shared<details::query_observation>(_observer, query) : nullptr;
+}
+
 //
-// Value management
+// Query observation
 //
 
-std::string details::blob_to_hex_string(const blob& data) {
-    static const char hex_digits[] = "0123456789abcdef";
-    std::string hex_str;
-    hex_str.reserve(data.size() * 2);
-    for (unsigned char byte : data) {
-        hex_str.push_back(hex_digits[byte >> 4]);
-        hex_str.push_back(hex_digits[byte & 0x0F]);
+size_t details::row_bytes(const row_base& row)
+{
+    size_t bytes = 0;
+    for (unsigned int index = 0; index < row.size(); ++index) {
+        bytes += row.value_size(index);
+    }
+    return bytes;
+}
+
+details::query_observation::query_observation(std::shared_ptr<connection_observer> observer, std::string query) :
+    _observer(std::move(observer)),
+    _query(std::move(query)),
+    _start(clock::now())
+{
+}
+
+details::query_observation::~query_observation()
+{
+    if (_fetching) {
+        _observer->on_fetch(_query, _rows, _bytes, clock::now() - _executed);
+    }
+}
+
+void details::query_observation::prepared(statement& stmt, bool cache_hit)
+{
+    stmt._observer = _observer;
+    stmt._query = _query;
+    _observer->on_prepare(_query, clock::now() - _start, cache_hit);
+}
+
+void details::query_observation::fetched(const buffered_resultset& rset)
+{
+    for (unsigned long long index = 0; index < rset.row_count(); ++index) {
+        fetched(rset.get_row(index));
     }
-    return hex_str;
 }
 
+void details::query_observation::executed(bool results)
+{
+    _executed = clock::now();
+    _fetching = results;
+    _observer->on_execute(_query, _executed - _start);
+}
+
+//
+// Value management
+//
+
 std::string to_string(const value& val)
 {
     return std::visit([](auto&& arg) -> std::string {
@@ -277,6 +391,28 @@ double to_double(const value& val) {
     }, val);
 }
 
+std::string_view to_string_view(const value& val)
+{
+    if(auto str = std::get_if<std::string>(&val)) {
+        return *str;
+    } else if(auto data = std::get_if<blob>(&val)) {
+        return {reinterpret_cast<const char*>(data->data()), data->size()};
+    } else {
+        return {};
+    }
+}
+
+blob_span to_blob_span(const value& val)
+{
+    if(auto data = std::get_if<blob>(&val)) {
+        return *data;
+    } else if(auto str = std::get_if<std::string>(&val)) {
+        return {reinterpret_cast<const unsigned char*>(str->data()), str->size()};
+    } else {
+        return {};
+    }
+}
+
 std::optional<std::string> to_string_opt(const value& val)
 {
     return std::visit([](auto&& arg) -> std::optional<std::string> {
@@ -414,6 +550,100 @@ std::vector<value> row_base::get_values() const
     return res;
 }
 
+static value_type storage_type_of(const value& val)
+{
+    switch(val.index()) {
+        case 1: return value_type::NULL_VALUE;
+        case 2: return value_type::STRING;
+        case 3: return value_type::BLOB;
+        case 4: return value_type::BOOL;
+        case 5: return value_type::INT;
+        case 6: return value_type::INT64;
+        case 7: return value_type::DOUBLE;
+        default: return value_type::UNSUPPORTED;
+    }
+}
+
+bool row_base::is_null(unsigned int index) const
+{
+    return sqlcpp::is_null(get_value(index));
+}
+
+value_type row_base::get_value_type(unsigned int index) const
+{
+    return storage_type_of(get_value(index));
+}
+
+size_t row_base::value_size(unsigned int index) const
+{
+    if (is_null(index)) {
+        return 0;
+    }
+    std::string_view data = get_value_string_view(index);
+    return data.data() != nullptr ? data.size() : sizeof(int64_t);
+}
+
+//
+// Cursor resultset
+//
+
+size_t cursor_resultset::fetch_batch(span<const batch_column> columns)
+{
+    if (!_batch_started) {
+        _batch_iterator = begin();
+        _batch_started = true;
+    }
+    size_t capacity = batch_column::capacity(columns);
+    size_t count = 0;
+    iterator last = end();
+    for (; count < capacity && _batch_iterator != last; ++count, ++_batch_iterator) {
+        const row& current = *_batch_iterator;
+        for (const auto& column : columns) {
+            column.set(count, current);
+        }
+    }
+    return count;
+}
+
+//
+// Buffered resultset
+//
+
+size_t buffered_resultset::fetch_batch(span<const batch_column> columns)
+{
+    size_t capacity = batch_column::capacity(columns);
+    size_t count = 0;
+    for (; count < capacity && _batch_row < row_count(); ++count, ++_batch_row) {
+        const row_base& row = get_row(_batch_row);
+        for (const auto& column : columns) {
+            column.set(count, row);
+        }
+    }
+    return count;
+}
+
+//
+// Typed row decoding
+//
+
+bool details::check_column_types(const cursor_resultset& rset, const std::vector<unsigned>& accepted)
+{
+    if(rset.column_count() != accepted.size()) {
+        // TODO throw exception
+        std::cerr << "Cannot decode " << rset.column_count() << " columns into " << accepted.size() << " fields" << std::endl;
+        return false;
+    }
+    for(unsigned int index = 0; index < accepted.size(); ++index) {
+        value_type type = rset.column_type(index);
+        if(type != NULL_VALUE && (type < 0 || (accepted[index] & (1u << type)) == 0)) {
+            // TODO throw exception
+            std::cerr << "Column " << rset.column_name(index) << " cannot be decoded into field " << index << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
 //
 // Generic row
 //
@@ -480,6 +710,21 @@ double details::generic_row::get_value_double(unsigned index) const
     return index < _values.size() ? to_double(_values[index]) : .0;
 }
 
+std::string_view details::generic_row::get_value_string_view(unsigned index) const
+{
+    return index < _values.size() ? to_string_view(_values[index]) : std::string_view{};
+}
+
+blob_span details::generic_row::get_value_blob_span(unsigned index) const
+{
+    return index < _values.size() ? to_blob_span(_values[index]) : blob_span{};
+}
+
+bool details::generic_row::is_null(unsigned index) const
+{
+    return index < _values.size() && sqlcpp::is_null(_values[index]);
+}
+
 //
 // Generic buffered resultset
 //
@@ -494,6 +739,97 @@ unsigned int details::generic_buffered_resultset::column_index(const std::string
     return ~0u;
 }
 
+const char* details::generic_buffered_resultset::store(const void* data, size_t size)
+{
+    if(size == 0) {
+        return nullptr;
+    }
+    char* res = static_cast<char*>(_arena.allocate(size, 1));
+    std::memcpy(res, data, size);
+    return res;
+}
+
+const details::generic_buffered_resultset::cell* details::generic_buffered_resultset::get_cell(size_t first, size_t size, unsigned index) const
+{
+    return index < size ? &_cells[first + index] : nullptr;
+}
+
+void details::generic_buffered_resultset::add_value(const value& val)
+{
+    cell c;
+    switch(val.index()) {
+        case 1:
+            c.type = value_type::NULL_VALUE;
+            break;
+        case 2:
+            add_string(std::get<std::string>(val));
+            return;
+        case 3:
+            add_blob(std::get<blob>(val));
+            return;
+        case 4:
+            c.type = value_type::BOOL;
+            c.b = std::get<bool>(val);
+            break;
+        case 5:
+            c.type = value_type::INT;
+            c.i = std::get<int>(val);
+            break;
+        case 6:
+            c.type = value_type::INT64;
+            c.l = std::get<int64_t>(val);
+            break;
+        case 7:
+            c.type = value_type::DOUBLE;
+            c.d = std::get<double>(val);
+            break;
+        default:
+            c.type = value_type::UNSUPPORTED;
+            break;
+    }
+    _cells.push_back(c);
+}
+
+void details::generic_buffered_resultset::add_string(std::string_view str)
+{
+    cell c;
+    c.type = value_type::STRING;
+    c.size = str.size();
+    c.data = store(str.data(), str.size());
+    _cells.push_back(c);
+}
+
+void details::generic_buffered_resultset::add_blob(blob_span data)
+{
+    cell c;
+    c.type = value_type::BLOB;
+    c.size = data.size();
+    c.data = store(data.data(), data.size());
+    _cells.push_back(c);
+}
+
+void details::generic_buffered_resultset::end_row()
+{
+    _rows.emplace_back(this, _row_start, _cells.size() - _row_start);
+    _row_start = _cells.size();
+}
+
+void details::generic_buffered_resultset::add_row(const generic_row& row)
+{
+    for(const auto& val : row.values()) {
+        add_value(val);
+    }
+    end_row();
+}
+
+void details::generic_buffered_resultset::add_row(const row_base& row)
+{
+    for(size_t index = 0; index < row.size(); ++index) {
+        add_value(row.get_value(index));
+    }
+    end_row();
+}
+
 resultset_row_iterator details::generic_buffered_resultset::begin() const
 {
     return {std::make_shared<generic_buffered_resultset_row_iterator_impl>(_rows.begin(), _rows.end())};
@@ -529,6 +865,429 @@ bool details::generic_buffered_resultset_row_iterator_impl::different(const resu
 
 
 
+//
+// Generic buffered resultset row
+//
+
+bool details::buffered_row::is_null(unsigned index) const
+{
+    auto c = _resultset->get_cell(_first, _size, index);
+    return c != nullptr && c->type == value_type::NULL_VALUE;
+}
+
+value details::buffered_row::get_value(unsigned index) const
+{
+    auto c = _resultset->get_cell(_first, _size, index);
+    if(c == nullptr) {
+        return {};
+    }
+    switch(c->type) {
+        case value_type::NULL_VALUE:
+            return nullptr;
+        case value_type::STRING:
+            return std::string(c->data, c->size);
+        case value_type::BLOB:
+            return blob(reinterpret_cast<const unsigned char*>(c->data), reinterpret_cast<const unsigned char*>(c->data) + c->size);
+        case value_type::BOOL:
+            return c->b;
+        case value_type::INT:
+            return c->i;
+        case value_type::INT64:
+            return c->l;
+        case value_type::DOUBLE:
+            return c->d;
+        default:
+            return {};
+    }
+}
+
+std::string details::buffered_row::get_value_string(unsigned index) const
+{
+    auto c = _resultset->get_cell(_first, _size, index);
+    if(c != nullptr && c->type == value_type::STRING) {
+        return std::string(c->data, c->size);
+    }
+    return c != nullptr ? to_string(get_value(index)) : "";
+}
+
+blob details::buffered_row::get_value_blob(unsigned index) const
+{
+    auto c = _resultset->get_cell(_first, _size, index);
+    if(c != nullptr && c->type == value_type::BLOB) {
+        return blob(reinterpret_cast<const unsigned char*>(c->data), reinterpret_cast<const unsigned char*>(c->data) + c->size);
+    }
+    return c != nullptr ? to_blob(get_value(index)) : blob{};
+}
+
+bool details::buffered_row::get_value_bool(unsigned index) const
+{
+    return to_bool(get_value(index));
+}
+
+int details::buffered_row::get_value_int(unsigned index) const
+{
+    return to_int(get_value(index));
+}
+
+int64_t details::buffered_row::get_value_int64(unsigned index) const
+{
+    return to_int64(get_value(index));
+}
+
+double details::buffered_row::get_value_double(unsigned index) const
+{
+    return to_double(get_value(index));
+}
+
+std::string_view details::buffered_row::get_value_string_view(unsigned index) const
+{
+    auto c = _resultset->get_cell(_first, _size, index);
+    if(c != nullptr && (c->type == value_type::STRING || c->type == value_type::BLOB)) {
+        return {c->data, c->size};
+    }
+    return {};
+}
+
+blob_span details::buffered_row::get_value_blob_span(unsigned index) const
+{
+    std::string_view data = get_value_string_view(index);
+    return {reinterpret_cast<const unsigned char*>(data.data()), data.size()};
+}
+
+
+
+//
+// Columnar buffered resultset
+//
+
+void details::columnar_buffered_resultset::add_column(const std::string& name, value_type type, const std::string& origin_name, const std::string& table_origin_name)
+{
+    column_info column;
+    column.name = name;
+    column.type = type;
+    column.origin_name = origin_name;
+    column.table_origin_name = table_origin_name;
+    // Previous rows have no value for this column
+    column.validity.resize((_row_count + 7) / 8, 0);
+    _columns.push_back(std::move(column));
+}
+
+void details::columnar_buffered_resultset::add_row(const row_base& row)
+{
+    size_t row_size = row.size();
+    for(size_t index = 0; index < _columns.size(); ++index) {
+        column_info& column = _columns[index];
+        if(index >= row_size) {
+            add_value(column, nullptr);
+            continue;
+        }
+        if((column.storage == value_type::STRING || column.storage == value_type::BLOB) && row.get_value_type(index) == column.storage) {
+            // Copied directly from the row view, when the value has the type of the column
+            add_data(column, row.get_value_string_view(index));
+            continue;
+        }
+        add_value(column, row.get_value(index));
+    }
+    ++_row_count;
+}
+
+void details::columnar_buffered_resultset::add_data(column_info& column, std::string_view data)
+{
+    if(_row_count % 8 == 0) {
+        column.validity.push_back(0);
+    }
+    column.validity.back() |= 1 << (_row_count % 8);
+    column.offsets.push_back(_arena.size());
+    column.sizes.push_back(data.size());
+    _arena.insert(_arena.end(), data.begin(), data.end());
+}
+
+void details::columnar_buffered_resultset::add_value(column_info& column, const value& val)
+{
+    value_type type = storage_type_of(val);
+    if(type != value_type::NULL_VALUE && type != column.storage && column.storage != value_type::UNSUPPORTED) {
+        if(column.storage == value_type::NULL_VALUE || (column.storage == value_type::INT && type == value_type::INT64)) {
+            set_storage(column, type);
+        } else if(column.storage != value_type::INT64 || type != value_type::INT) {
+            // Mixed value types
+            set_storage(column, value_type::UNSUPPORTED);
+        }
+    }
+
+    if(type == value_type::STRING || type == value_type::BLOB) {
+        if(column.storage != value_type::UNSUPPORTED) {
+            add_data(column, to_string_view(val));
+            return;
+        }
+    }
+
+    if(_row_count % 8 == 0) {
+        column.validity.push_back(0);
+    }
+    if(type != value_type::NULL_VALUE) {
+        column.validity.back() |= 1 << (_row_count % 8);
+    }
+    switch(column.storage) {
+        case value_type::BOOL:
+            column.bools.push_back(type == value_type::BOOL && std::get<bool>(val) ? 1 : 0);
+            break;
+        case value_type::INT:
+            column.ints.push_back(type == value_type::INT ? std::get<int>(val) : 0);
+            break;
+        case value_type::INT64:
+            column.int64s.push_back(to_int64(val));
+            break;
+        case value_type::DOUBLE:
+            column.doubles.push_back(to_double(val));
+            break;
+        case value_type::STRING:
+        case value_type::BLOB:
+            // Null value
+            column.offsets.push_back(_arena.size());
+            column.sizes.push_back(0);
+            break;
+        case value_type::UNSUPPORTED:
+            column.values.push_back(val);
+            break;
+        default:
+            // Only null values so far
+            break;
+    }
+}
+
+void details::columnar_buffered_resultset::set_storage(column_info& column, value_type storage)
+{
+    if(column.storage == value_type::NULL_VALUE) {
+        // All previous values are null
+        switch(storage) {
+            case value_type::BOOL: column.bools.resize(_row_count, 0); break;
+            case value_type::INT: column.ints.resize(_row_count, 0); break;
+            case value_type::INT64: column.int64s.resize(_row_count, 0); break;
+            case value_type::DOUBLE: column.doubles.resize(_row_count, 0.0); break;
+            case value_type::STRING:
+            case value_type::BLOB:
+                column.offsets.resize(_row_count, 0);
+                column.sizes.resize(_row_count, 0);
+                break;
+            default:
+                column.values.resize(_row_count, nullptr);
+                storage = value_type::UNSUPPORTED;
+                break;
+        }
+    } else if(column.storage == value_type::INT && storage == value_type::INT64) {
+        column.int64s.assign(column.ints.begin(), column.ints.end());
+        std::vector<int>().swap(column.ints);
+    } else {
+        // Fall back to generic values
+        std::vector<value> values;
+        values.reserve(_row_count + 1);
+        for(unsigned long long row = 0; row < _row_count; ++row) {
+            values.push_back(column_value(column, row));
+        }
+        std::vector<uint8_t>().swap(column.bools);
+        std::vector<int>().swap(column.ints);
+        std::vector<int64_t>().swap(column.int64s);
+        std::vector<double>().swap(column.doubles);
+        std::vector<size_t>().swap(column.offsets);
+        std::vector<size_t>().swap(column.sizes);
+        column.values = std::move(values);
+        storage = value_type::UNSUPPORTED;
+    }
+    column.storage = storage;
+}
+
+std::string_view details::columnar_buffered_resultset::data(const column_info& column, unsigned long long row) const
+{
+    return {_arena.data() + column.offsets[row], column.sizes[row]};
+}
+
+value details::columnar_buffered_resultset::column_value(const column_info& column, unsigned long long row) const
+{
+    if(!((column.validity[row / 8] >> (row % 8)) & 1)) {
+        return nullptr;
+    }
+    switch(column.storage) {
+        case value_type::BOOL:
+            return column.bools[row] != 0;
+        case value_type::INT:
+            return column.ints[row];
+        case value_type::INT64:
+            return column.int64s[row];
+        case value_type::DOUBLE:
+            return column.doubles[row];
+        case value_type::STRING:
+            return std::string(data(column, row));
+        case value_type::BLOB: {
+            std::string_view str = data(column, row);
+            return blob(str.begin(), str.end());
+        }
+        case value_type::UNSUPPORTED:
+            return column.values[row];
+        default:
+            return nullptr;
+    }
+}
+
+unsigned int details::columnar_buffered_resultset::column_index(const std::string &name) const
+{
+    for (size_t index = 0; index < _columns.size(); ++index) {
+        if (_columns[index].name == name) {
+            return index;
+        }
+    }
+    return ~0u;
+}
+
+const row_base& details::columnar_buffered_resultset::get_row(unsigned long long index) const
+{
+    if(index >= _row_count) {
+        throw std::out_of_range("Invalid row index");
+    }
+    _current_row.set(index);
+    return _current_row;
+}
+
+std::string_view details::columnar_buffered_resultset::string_value(unsigned int index, unsigned long long row) const
+{
+    const column_info& column = _columns[index];
+    if(column.storage == value_type::STRING || column.storage == value_type::BLOB) {
+        return data(column, row);
+    }
+    return {};
+}
+
+blob_span details::columnar_buffered_resultset::blob_value(unsigned int index, unsigned long long row) const
+{
+    std::string_view str = string_value(index, row);
+    return {reinterpret_cast<const unsigned char*>(str.data()), str.size()};
+}
+
+resultset_row_iterator details::columnar_buffered_resultset::begin() const
+{
+    return {std::make_shared<columnar_buffered_resultset_row_iterator_impl>(this, 0, _row_count)};
+}
+
+resultset_row_iterator details::columnar_buffered_resultset::end() const
+{
+    return {std::make_shared<columnar_buffered_resultset_row_iterator_impl>(this, _row_count, _row_count)};
+}
+
+//
+// Columnar row
+//
+
+size_t details::columnar_row::size() const
+{
+    return _resultset->_columns.size();
+}
+
+bool details::columnar_row::is_null(unsigned index) const
+{
+    return !_resultset->is_valid(index, _row);
+}
+
+value details::columnar_row::get_value(unsigned index) const
+{
+    return _resultset->column_value(_resultset->_columns[index], _row);
+}
+
+std::string details::columnar_row::get_value_string(unsigned index) const
+{
+    const auto& column = _resultset->_columns[index];
+    if(column.storage == value_type::STRING) {
+        return std::string(_resultset->data(column, _row));
+    }
+    return to_string(get_value(index));
+}
+
+blob details::columnar_row::get_value_blob(unsigned index) const
+{
+    const auto& column = _resultset->_columns[index];
+    if(column.storage == value_type::STRING || column.storage == value_type::BLOB) {
+        std::string_view str = _resultset->data(column, _row);
+        return blob(str.begin(), str.end());
+    }
+    return to_blob(get_value(index));
+}
+
+bool details::columnar_row::get_value_bool(unsigned index) const
+{
+    const auto& column = _resultset->_columns[index];
+    if(column.storage == value_type::BOOL) {
+        return column.bools[_row] != 0;
+    }
+    return to_bool(get_value(index));
+}
+
+int details::columnar_row::get_value_int(unsigned index) const
+{
+    const auto& column = _resultset->_columns[index];
+    switch(column.storage) {
+        case value_type::INT: return column.ints[_row];
+        case value_type::INT64: return (int) column.int64s[_row];
+        default: return to_int(get_value(index));
+    }
+}
+
+int64_t details::columnar_row::get_value_int64(unsigned index) const
+{
+    const auto& column = _resultset->_columns[index];
+    switch(column.storage) {
+        case value_type::INT: return column.ints[_row];
+        case value_type::INT64: return column.int64s[_row];
+        default: return to_int64(get_value(index));
+    }
+}
+
+double details::columnar_row::get_value_double(unsigned index) const
+{
+    const auto& column = _resultset->_columns[index];
+    if(column.storage == value_type::DOUBLE) {
+        return column.doubles[_row];
+    }
+    return to_double(get_value(index));
+}
+
+std::string_view details::columnar_row::get_value_string_view(unsigned index) const
+{
+    const auto& column = _resultset->_columns[index];
+    if(column.storage == value_type::UNSUPPORTED) {
+        return to_string_view(column.values[_row]);
+    }
+    return _resultset->string_value(index, _row);
+}
+
+blob_span details::columnar_row::get_value_blob_span(unsigned index) const
+{
+    std::string_view str = get_value_string_view(index);
+    return {reinterpret_cast<const unsigned char*>(str.data()), str.size()};
+}
+
+//
+// columnar_buffered_resultset_row_iterator_impl
+//
+
+const row_base& details::columnar_buffered_resultset_row_iterator_impl::get() const
+{
+    return _row;
+}
+
+bool details::columnar_buffered_resultset_row_iterator_impl::next()
+{
+    _row.set(_row.row() + 1);
+    return _row.row() < _end;
+}
+
+bool details::columnar_buffered_resultset_row_iterator_impl::different(const resultset_row_iterator_impl &other) const
+{
+    if(auto impl = dynamic_cast<const columnar_buffered_resultset_row_iterator_impl*>(&other) ; impl!=nullptr) {
+        return _row.row() != impl->_row.row();
+    } else {
+        return true;
+    }
+}
+
+
 //
 // Simple stats result
 //
@@ -548,6 +1307,160 @@ unsigned long long details::simple_stats_result::last_insert_id() const
 // SQLCPP statement
 //
 
+std::shared_ptr<columnar_resultset> statement::execute_columnar()
+{
+    // Generic implementation, filled from the driver cursor rows
+    std::shared_ptr<cursor_resultset> rset = execute();
+    if(!rset) {
+        return {};
+    }
+    auto res = std::make_shared<details::columnar_buffered_resultset>();
+    for(unsigned int index = 0; index < rset->column_count(); ++index) {
+        res->add_column(rset->column_name(index), rset->column_type(index), rset->column_origin_name(index), rset->table_origin_name(index));
+    }
+    for(const row& row : *rset) {
+        res->add_row(row);
+    }
+    res->affected_rows(rset->affected_rows());
+    res->last_insert_id(rset->last_insert_id());
+    return res;
+}
+
+std::shared_ptr<details::query_observation> statement::observe() const
+{
+    return _observer ? std::make_shared<details::query_observation>(_observer, _query) : nullptr;
+}
+
+void statement::reset()
+{
+    _array_params.clear();
+}
+
+statement& statement::bind_array(unsigned int index, array_param::type_t type, const void* data, size_t size, span<const uint8_t> nulls)
+{
+    if(!nulls.empty() && nulls.size() != size) {
+        std::cerr << "Parameter array null flags must have one value per row" << std::endl;
+        // TODO throw exception
+        return *this;
+    }
+    array_param param{index, type, data, size, nulls};
+    for(auto& existing : _array_params) {
+        if(existing.index == index) {
+            existing = param;
+            return *this;
+        }
+    }
+    _array_params.push_back(param);
+    return *this;
+}
+
+statement& statement::bind_array(unsigned int index, span<const bool> values, span<const uint8_t> nulls)
+{
+    return bind_array(index, array_param::BOOL, values.data(), values.size(), nulls);
+}
+
+statement& statement::bind_array(unsigned int index, span<const int> values, span<const uint8_t> nulls)
+{
+    return bind_array(index, array_param::INT, values.data(), values.size(), nulls);
+}
+
+statement& statement::bind_array(unsigned int index, span<const int64_t> values, span<const uint8_t> nulls)
+{
+    return bind_array(index, array_param::INT64, values.data(), values.size(), nulls);
+}
+
+statement& statement::bind_array(unsigned int index, span<const double> values, span<const uint8_t> nulls)
+{
+    return bind_array(index, array_param::DOUBLE, values.data(), values.size(), nulls);
+}
+
+statement& statement::bind_array(unsigned int index, span<const std::string> values, span<const uint8_t> nulls)
+{
+    return bind_array(index, array_param::STRING, values.data(), values.size(), nulls);
+}
+
+statement& statement::bind_array(unsigned int index, span<const std::string_view> values, span<const uint8_t> nulls)
+{
+    return bind_array(index, array_param::STRING_VIEW, values.data(), values.size(), nulls);
+}
+
+statement& statement::bind_array(unsigned int index, span<const blob> values, span<const uint8_t> nulls)
+{
+    return bind_array(index, array_param::BLOB, values.data(), values.size(), nulls);
+}
+
+std::optional<size_t> statement::array_size() const
+{
+    if(_array_params.empty()) {
+        std::cerr << "No parameter array bound" << std::endl;
+        return {};
+    }
+    size_t size = _array_params.front().size;
+    for(const auto& param : _array_params) {
+        if(param.size != size) {
+            std::cerr << "Parameter arrays have different sizes" << std::endl;
+            return {};
+        }
+    }
+    return size;
+}
+
+void statement::bind_array_row(size_t row)
+{
+    for(const auto& param : _array_params) {
+        if(param.is_null(row)) {
+            bind_null(param.index);
+            continue;
+        }
+        switch(param.type) {
+            case array_param::BOOL:
+                bind(param.index, param.get<bool>(row));
+                break;
+            case array_param::INT:
+                bind(param.index, param.get<int>(row));
+                break;
+            case array_param::INT64:
+                bind(param.index, param.get<int64_t>(row));
+                break;
+            case array_param::DOUBLE:
+                bind(param.index, param.get<double>(row));
+                break;
+            // Arrays outlive the executions, their values are not copied
+            case array_param::STRING:
+                bind_ref(param.index, std::string_view(param.get<std::string>(row)));
+                break;
+            case array_param::STRING_VIEW:
+                bind_ref(param.index, param.get<std::string_view>(row));
+                break;
+            case array_param::BLOB:
+                bind_ref(param.index, blob_span(param.get<blob>(row)));
+                break;
+        }
+    }
+}
+
+std::shared_ptr<stats_result> statement::execute_array()
+{
+    std::optional<size_t> rows = array_size();
+    if(!rows) {
+        // TODO throw exception
+        return {};
+    }
+    unsigned long long affected_rows = 0;
+    unsigned long long last_insert_id = 0;
+    for(size_t row = 0; row < *rows; ++row) {
+        bind_array_row(row);
+        std::shared_ptr<cursor_resultset> res = execute();
+        if(!res) {
+            // TODO throw exception
+            return {};
+        }
+        affected_rows += res->affected_rows();
+        last_insert_id = res->last_insert_id();
+    }
+    return std::make_shared<details::simple_stats_result>(affected_rows, last_insert_id);
+}
+
 statement& statement::bind_null(const std::string& name)
 {
     return bind(name, nullptr);
@@ -558,6 +1471,16 @@ statement& statement::bind_null(unsigned int index)
     return bind(index, nullptr);
 }
 
+statement& statement::bind_ref(unsigned int index, const std::string_view& value)
+{
+    return bind(index, value);
+}
+
+statement& statement::bind_ref(unsigned int index, const blob_span& value)
+{
+    return bind(index, blob(value.begin(), value.end()));
+}
+
 //
 // SQLCPP resultset row iterator
 //
@@ -566,7 +1489,7 @@ resultset_row_iterator& resultset_row_iterator::operator++()
 {
     if(_impl) {
         _impl->next();
-        _row = row(&_impl->get());
+        _row = row(nullptr);
     }
     return *this;
 }
@@ -575,7 +1498,7 @@ void resultset_row_iterator::operator++(int)
 {
     if(_impl) {
         _impl->next();
-        _row = row(&_impl->get());
+        _row = row(nullptr);
     }
 }
 
@@ -590,11 +1513,14 @@ bool resultset_row_iterator::operator!=(const resultset_row_iterator& other) con
     }
 }
 
-const row& resultset_row_iterator::operator*() const
+const row& resultset_row_iterator::current() const
 {
     if(_impl) {
         if(!_row) {
             _row = row(&_impl->get());
+            if(_observation) {
+                _observation->fetched(_row);
+            }
         }
         return _row;
     } else {
@@ -602,16 +1528,14 @@ const row& resultset_row_iterator::operator*() const
     }
 }
 
+const row& resultset_row_iterator::operator*() const
+{
+    return current();
+}
+
 const row& resultset_row_iterator::operator->() const
 {
-    if(_impl) {
-        if(!_row) {
-            _row = row(&_impl->get());
-        }
-        return _row;
-    } else {
-        throw std::runtime_error("Invalid iterator");
-    }
+    return current();
 }
 
 } // namespace sqlcpp
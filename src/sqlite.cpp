@@ -47,11 +47,22 @@
  * - INTEGER or REAL is false if 0, true otherwise
  * - TEXT is false if "false", true otherwise
  * - BLOB is false if empty, true otherwise
+ *
+ * Strings and blobs are bound with the *64 variants, so payloads over 2GB are not truncated.
+ * bind() lets SQLite copy them (SQLITE_TRANSIENT), bind_ref() does not (SQLITE_STATIC):
+ * the referenced memory is read at each step until the parameter is bound again,
+ * the statement is reset with reset() or destroyed.
  */
 
 namespace sqlcpp::sqlite
 {
 
+// Column names are null for expressions and when metadata is not available
+static std::string name_or_empty(const char* name)
+{
+    return name != nullptr ? name : "";
+}
+
 class statement;
 class resultset;
 
@@ -88,6 +99,11 @@ public:
     int get_value_int(unsigned int index) const override;
     int64_t get_value_int64(unsigned int index) const override;
     double get_value_double(unsigned int index) const override;
+    std::string_view get_value_string_view(unsigned int index) const override;
+    blob_span get_value_blob_span(unsigned int index) const override;
+    bool is_null(unsigned int index) const override;
+    value_type get_value_type(unsigned int index) const override;
+    size_t value_size(unsigned int index) const override;
 };
 
 const row_base& resultset_row_iterator_impl::get() const
@@ -123,6 +139,25 @@ size_t resultset_row_iterator_impl::size() const
     return sqlite3_column_count(_stmt.get());
 }
 
+bool resultset_row_iterator_impl::is_null(unsigned int index) const
+{
+    return sqlite3_column_type(_stmt.get(), index) == SQLITE_NULL;
+}
+
+size_t resultset_row_iterator_impl::value_size(unsigned int index) const
+{
+    switch(sqlite3_column_type(_stmt.get(), index)) {
+        case SQLITE_NULL:
+            return 0;
+        case SQLITE_TEXT:
+        case SQLITE_BLOB:
+            return sqlite3_column_bytes(_stmt.get(), index);
+        default:
+            // Not sqlite3_column_bytes(), numbers would be converted to text
+            return sizeof(int64_t);
+    }
+}
+
 value resultset_row_iterator_impl::get_value(unsigned int index) const
 {
     switch(sqlite3_column_type(_stmt.get(), index)) {
@@ -189,6 +224,27 @@ double resultset_row_iterator_impl::get_value_double(unsigned int index) const
     return sqlite3_column_double(_stmt.get(), index);
 }
 
+std::string_view resultset_row_iterator_impl::get_value_string_view(unsigned int index) const
+{
+    // Pointers stay valid until the next step, as long as no other type conversion is requested
+    switch(sqlite3_column_type(_stmt.get(), index)) {
+        case SQLITE_TEXT:
+        case SQLITE_BLOB: {
+            const char* data = static_cast<const char*>(sqlite3_column_blob(_stmt.get(), index));
+            int size = sqlite3_column_bytes(_stmt.get(), index);
+            return data != nullptr ? std::string_view(data, size) : std::string_view{};
+        }
+        default:
+            return {};
+    }
+}
+
+blob_span resultset_row_iterator_impl::get_value_blob_span(unsigned int index) const
+{
+    std::string_view data = get_value_string_view(index);
+    return {reinterpret_cast<const unsigned char*>(data.data()), data.size()};
+}
+
 
 //
 // SQLite's resultset
@@ -223,6 +279,8 @@ public:
     resultset_row_iterator begin() const override;
     resultset_row_iterator end() const override;
 
+    size_t fetch_batch(span<const batch_column> columns) override;
+
     static value_type convert_column_type(int column_type);
 };
 
@@ -244,6 +302,11 @@ value_type resultset::convert_column_type(int column_type)
     }
 }
 
+value_type resultset_row_iterator_impl::get_value_type(unsigned int index) const
+{
+    return resultset::convert_column_type(sqlite3_column_type(_stmt.get(), index));
+}
+
 unsigned long long resultset::affected_rows() const {
     // TODO
     return 0;
@@ -261,7 +324,7 @@ unsigned int resultset::column_count() const
 
 std::string resultset::column_name(unsigned int index) const
 {
-    return sqlite3_column_name(_stmt.get(), index);
+    return name_or_empty(sqlite3_column_name(_stmt.get(), index));
 }
 
 unsigned int resultset::column_index(const std::string& name) const
@@ -276,12 +339,12 @@ unsigned int resultset::column_index(const std::string& name) const
 
 std::string resultset::column_origin_name(unsigned int index) const 
 {
-    return sqlite3_column_origin_name(_stmt.get(), index);
+    return name_or_empty(sqlite3_column_origin_name(_stmt.get(), index));
 }
 
 std::string resultset::table_origin_name(unsigned int index) const
 {
-    return sqlite3_column_table_name(_stmt.get(), index);
+    return name_or_empty(sqlite3_column_table_name(_stmt.get(), index));
 }
 
 value_type resultset::column_type(unsigned int index) const
@@ -306,6 +369,33 @@ sqlcpp::resultset_row_iterator resultset::end() const
     return std::move(sqlcpp::cursor_resultset::create_iterator(std::make_unique<resultset_row_iterator_impl>(_stmt, SQLITE_DONE)));
 }
 
+size_t resultset::fetch_batch(span<const batch_column> columns)
+{
+    sqlite3_stmt* stmt = _stmt.get();
+    size_t capacity = batch_column::capacity(columns);
+    size_t count = 0;
+    size_t values = 0;
+    // The current row is the next one to fetch
+    for (; count < capacity && _state == SQLITE_ROW; ++count) {
+        for (const auto& column : columns) {
+            if (sqlite3_column_type(stmt, column.index()) == SQLITE_NULL) {
+                column.set_null(count);
+                continue;
+            } else if (column.type() == value_type::INT64) {
+                column.set(count, (int64_t) sqlite3_column_int64(stmt, column.index()));
+            } else {
+                column.set(count, sqlite3_column_double(stmt, column.index()));
+            }
+            ++values;
+        }
+        _state = sqlite3_step(stmt);
+    }
+    if (_observation) {
+        _observation->fetched(count, values * sizeof(int64_t));
+    }
+    return count;
+}
+
 
 
 //
@@ -316,6 +406,10 @@ class statement : public sqlcpp::statement
 {
 protected:
     std::shared_ptr<sqlite3_stmt> _stmt;
+    // Stepped since the last reset, must be reset before binding or executing again
+    bool _stepped = false;
+
+    void rewind();
 
 public:
     explicit statement(std::shared_ptr<sqlite3_stmt> stmt) :
@@ -332,6 +426,10 @@ public:
     void execute(std::function<void(const row_base&)> func) override;
     std::shared_ptr<sqlcpp::buffered_resultset> execute_buffered() override;
 
+    std::shared_ptr<stats_result> execute_array() override;
+
+    void reset() override;
+
     unsigned int parameter_count() const override;
     int parameter_index(const std::string& name) const override;
     std::string parameter_name(unsigned int index) const override;
@@ -355,15 +453,27 @@ public:
     statement& bind(unsigned int index, int64_t value) override;
     statement& bind(unsigned int index, double value) override;
     statement& bind(unsigned int index, const value& value) override;
+
+    statement& bind_ref(unsigned int index, const std::string_view& value) override;
+    statement& bind_ref(unsigned int index, const blob_span& value) override;
 };
 
 std::shared_ptr<sqlcpp::cursor_resultset> statement::execute()
 {
+    std::shared_ptr<details::query_observation> observation = observe();
+    rewind();
+    _stepped = true;
     int rc = sqlite3_step(_stmt.get());
     switch(rc) {
         case SQLITE_DONE:
-        case SQLITE_ROW:
-            return std::shared_ptr<sqlcpp::cursor_resultset>{new resultset(_stmt, rc)};
+        case SQLITE_ROW: {
+            auto rset = std::make_shared<resultset>(_stmt, rc);
+            if(observation) {
+                observation->executed();
+                rset->observe(std::move(observation));
+            }
+            return rset;
+        }
         default:
             // TODO process errors
             // Throw exception
@@ -373,50 +483,23 @@ std::shared_ptr<sqlcpp::cursor_resultset> statement::execute()
 
 void statement::execute(std::function<void(const row_base&)> func)
 {
+    std::shared_ptr<details::query_observation> observation = observe();
+    rewind();
+    _stepped = true;
     int rc = sqlite3_step(_stmt.get());
     switch(rc) {
         case SQLITE_DONE:
         case SQLITE_ROW: {
-            std::vector<value_type> columns;
-            for(int index=0; index< sqlite3_column_count(_stmt.get()); ++index) {
-                columns.push_back(resultset::convert_column_type(sqlite3_column_type(_stmt.get(), index)));
+            if(observation) {
+                observation->executed();
             }
-            size_t col_count = columns.size();
+            // Values are read directly from the statement, nothing is copied for each row
+            resultset_row_iterator_impl row(_stmt, rc);
             while(rc == SQLITE_ROW) {
-                details::generic_row row;
-                for(size_t index=0; index<col_count; ++index) {
-                    switch(sqlite3_column_type(_stmt.get(), index)) {
-                        case SQLITE_NULL:
-                            row.add_value(nullptr);
-                            break;
-                        case SQLITE_INTEGER:
-                            row.add_value(sqlite3_column_int64(_stmt.get(), index));
-                            break;
-                        case SQLITE_FLOAT:
-                            row.add_value(sqlite3_column_double(_stmt.get(), index));
-                            break;
-                        case SQLITE_TEXT: {
-                            const char* s = reinterpret_cast<const char*>(sqlite3_column_text(_stmt.get(), index));
-                            row.add_value(std::string(s != nullptr ? s : ""));
-                            break;
-                        }
-                        case SQLITE_BLOB: {
-                            const void* data = sqlite3_column_blob(_stmt.get(), index);
-                            int size = sqlite3_column_bytes(_stmt.get(), index);
-                            if(data == nullptr || size == 0) {
-                                // TODO throw exception ?
-                                row.add_value(nullptr);
-                            } else {
-                                row.add_value(blob(reinterpret_cast<const unsigned char*>(data), reinterpret_cast<const unsigned char*>(data) + size));
-                            }
-                            break;
-                        }
-                        default:
-                            row.add_value(std::monostate{});
-                            break;
-                    }
+                if(observation) {
+                    observation->fetched(row.get());
                 }
-                func(std::move(row));
+                func(row.get());
                 rc = sqlite3_step(_stmt.get());
             }
         }
@@ -429,57 +512,63 @@ void statement::execute(std::function<void(const row_base&)> func)
 
 std::shared_ptr<sqlcpp::buffered_resultset> statement::execute_buffered()
 {
+    std::shared_ptr<details::query_observation> observation = observe();
+    rewind();
+    _stepped = true;
     int rc = sqlite3_step(_stmt.get());
     switch(rc) {
         case SQLITE_DONE:
         case SQLITE_ROW: {
+            if(observation) {
+                observation->executed();
+            }
             auto buff = std::make_shared<details::generic_buffered_resultset>();
             //buff->last_insert_id(0);
             //buff->affected_rows(0);
             for(int index=0; index< sqlite3_column_count(_stmt.get()); ++index) {
                 buff->add_column(
-                    sqlite3_column_name(_stmt.get(), index),
+                    name_or_empty(sqlite3_column_name(_stmt.get(), index)),
                     resultset::convert_column_type(sqlite3_column_type(_stmt.get(), index)),
-                    sqlite3_column_origin_name(_stmt.get(), index),
-                    sqlite3_column_table_name(_stmt.get(), index)
+                    name_or_empty(sqlite3_column_origin_name(_stmt.get(), index)),
+                    name_or_empty(sqlite3_column_table_name(_stmt.get(), index))
                     );
             }
             size_t col_count = buff->column_count();
             while(rc == SQLITE_ROW) {
-                details::generic_row row;
                 for(size_t index=0; index<col_count; ++index) {
                     switch(sqlite3_column_type(_stmt.get(), index)) {
                         case SQLITE_NULL:
-                            row.add_value(nullptr);
+                            buff->add_value(nullptr);
                             break;
                         case SQLITE_INTEGER:
-                            row.add_value(sqlite3_column_int64(_stmt.get(), index));
+                            buff->add_value(sqlite3_column_int64(_stmt.get(), index));
                             break;
                         case SQLITE_FLOAT:
-                            row.add_value(sqlite3_column_double(_stmt.get(), index));
+                            buff->add_value(sqlite3_column_double(_stmt.get(), index));
                             break;
                         case SQLITE_TEXT: {
                             const char* s = reinterpret_cast<const char*>(sqlite3_column_text(_stmt.get(), index));
-                            row.add_value(std::string(s != nullptr ? s : ""));
+                            int size = sqlite3_column_bytes(_stmt.get(), index);
+                            buff->add_string(s != nullptr ? std::string_view(s, size) : std::string_view{});
                             break;
                         }
                         case SQLITE_BLOB: {
                             const void* data = sqlite3_column_blob(_stmt.get(), index);
                             int size = sqlite3_column_bytes(_stmt.get(), index);
-                            if(data == nullptr || size == 0) {
-                                return {};
-                            }
-                            row.add_value(blob(reinterpret_cast<const unsigned char*>(data), reinterpret_cast<const unsigned char*>(data) + size));
+                            buff->add_blob({reinterpret_cast<const unsigned char*>(data), data != nullptr ? (size_t) size : 0});
                             break;
                         }
                         default:
-                            row.add_value(std::monostate{});
+                            buff->add_value(std::monostate{});
                             break;
                     }
                 }
-                buff->add_row(std::move(row));
+                buff->end_row();
                 rc = sqlite3_step(_stmt.get());
             }
+            if(observation) {
+                observation->fetched(*buff);
+            }
             return buff;
         }
         default:
@@ -489,6 +578,75 @@ std::shared_ptr<sqlcpp::buffered_resultset> statement::execute_buffered()
     }
 }
 
+std::shared_ptr<stats_result> statement::execute_array()
+{
+    std::optional<size_t> rows = array_size();
+    if(!rows) {
+        // TODO throw exception
+        return {};
+    }
+    std::shared_ptr<details::query_observation> observation = observe();
+    sqlite3* db = sqlite3_db_handle(_stmt.get());
+
+    // Run all rows in one transaction, unless one is already open
+    bool transaction = sqlite3_get_autocommit(db) != 0;
+    if(transaction && sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to begin transaction: " << sqlite3_errmsg(db) << std::endl;
+        // TODO throw exception
+        return {};
+    }
+
+    sqlite3_int64 changes = 0;
+    for(size_t row = 0; row < *rows; ++row) {
+        bind_array_row(row);
+        rewind();
+        _stepped = true;
+        int rc;
+        while((rc = sqlite3_step(_stmt.get())) == SQLITE_ROW) {
+        }
+        if(rc != SQLITE_DONE) {
+            std::cerr << "Failed to execute statement (" << rc << "): " << sqlite3_errmsg(db) << std::endl;
+            rewind();
+            if(transaction) {
+                sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+            }
+            // TODO throw exception
+            return {};
+        }
+        changes += sqlite3_changes64(db);
+    }
+    sqlite3_int64 last_insert_id = sqlite3_last_insert_rowid(db);
+    rewind();
+
+    if(transaction && sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to commit transaction: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+        // TODO throw exception
+        return {};
+    }
+    if(observation) {
+        observation->executed(false);
+    }
+    return std::make_shared<details::simple_stats_result>(changes, last_insert_id);
+}
+
+void statement::rewind()
+{
+    // Bindings are kept, only the execution state is reset
+    if(_stepped) {
+        sqlite3_reset(_stmt.get());
+        _stepped = false;
+    }
+}
+
+void statement::reset()
+{
+    sqlcpp::statement::reset();
+    sqlite3_reset(_stmt.get());
+    sqlite3_clear_bindings(_stmt.get());
+    _stepped = false;
+}
+
 unsigned int statement::parameter_count() const
 {
     return sqlite3_bind_parameter_count(_stmt.get());
@@ -508,6 +666,7 @@ std::string statement::parameter_name(unsigned int index) const
 
 statement& statement::bind(const std::string& name, std::nullptr_t) 
 {
+    rewind();
     int idx = parameter_index(name);
     if(idx >= 0) {
         sqlite3_bind_null(_stmt.get(), idx+1);
@@ -520,9 +679,10 @@ statement& statement::bind(const std::string& name, std::nullptr_t)
 
 statement& statement::bind(const std::string& name, const std::string& value)
 {
+    rewind();
     int idx = parameter_index(name);
     if(idx >= 0) {
-        sqlite3_bind_text(_stmt.get(), idx+1, value.c_str(), value.size(), SQLITE_TRANSIENT);
+        sqlite3_bind_text64(_stmt.get(), idx+1, value.c_str(), value.size(), SQLITE_TRANSIENT, SQLITE_UTF8);
         // TODO process error, throw exception
     } else {
         // TODO process error, throw exception
@@ -532,9 +692,10 @@ statement& statement::bind(const std::string& name, const std::string& value)
 
 statement& statement::bind(const std::string& name, const std::string_view& value)
 {
+    rewind();
     int idx = parameter_index(name);
     if(idx >= 0) {
-        sqlite3_bind_text(_stmt.get(), idx+1, value.data(), value.size(), SQLITE_TRANSIENT);
+        sqlite3_bind_text64(_stmt.get(), idx+1, value.data(), value.size(), SQLITE_TRANSIENT, SQLITE_UTF8);
         // TODO process error, throw exception
     } else {
         // TODO process error, throw exception
@@ -544,9 +705,10 @@ statement& statement::bind(const std::string& name, const std::string_view& valu
 
 statement& statement::bind(const std::string& name, const blob& value) 
 {
+    rewind();
     int idx = parameter_index(name);
     if(idx >= 0) {
-        sqlite3_bind_blob(_stmt.get(), idx+1, value.data(), value.size(), SQLITE_TRANSIENT);
+        sqlite3_bind_blob64(_stmt.get(), idx+1, value.data(), value.size(), SQLITE_TRANSIENT);
         // TODO process error, throw exception
     } else {
         // TODO process error, throw exception
@@ -556,6 +718,7 @@ statement& statement::bind(const std::string& name, const blob& value)
 
 statement& statement::bind(const std::string& name, bool value)
 {
+    rewind();
     int idx = parameter_index(name);
     if(idx >= 0) {
         sqlite3_bind_int(_stmt.get(), idx+1, value ? 1 : 0);
@@ -568,6 +731,7 @@ statement& statement::bind(const std::string& name, bool value)
 
 statement& statement::bind(const std::string& name, int value)
 {
+    rewind();
     int idx = parameter_index(name);
     if(idx >= 0) {
         sqlite3_bind_int(_stmt.get(), idx+1, value);
@@ -580,6 +744,7 @@ statement& statement::bind(const std::string& name, int value)
 
 statement& statement::bind(const std::string& name, int64_t value)  
 {
+    rewind();
     int idx = parameter_index(name);
     if(idx >= 0) {
         sqlite3_bind_int64(_stmt.get(), idx+1, value);
@@ -592,6 +757,7 @@ statement& statement::bind(const std::string& name, int64_t value)
 
 statement& statement::bind(const std::string& name, double value)  
 {
+    rewind();
     int idx = parameter_index(name);
     if(idx >= 0) {
         sqlite3_bind_double(_stmt.get(), idx+1, value);
@@ -604,6 +770,7 @@ statement& statement::bind(const std::string& name, double value)
 
 statement& statement::bind(const std::string& name, const value& value)  
 {
+    rewind();
     std::visit([&](auto&& arg) {
         bind(name, arg);
     }, value);
@@ -612,6 +779,7 @@ statement& statement::bind(const std::string& name, const value& value)
 
 statement& statement::bind(unsigned int index, std::nullptr_t)  
 {
+    rewind();
     sqlite3_bind_null(_stmt.get(), index + 1);
     // TODO process error, throw exception
     return *this;
@@ -619,27 +787,31 @@ statement& statement::bind(unsigned int index, std::nullptr_t)
 
 statement& statement::bind(unsigned int index, const std::string& value)  
 {
-    sqlite3_bind_text(_stmt.get(), index + 1, value.c_str(), value.size(), SQLITE_TRANSIENT);
+    rewind();
+    sqlite3_bind_text64(_stmt.get(), index + 1, value.c_str(), value.size(), SQLITE_TRANSIENT, SQLITE_UTF8);
     // TODO process error, throw exception
     return *this;
 }
 
 statement& statement::bind(unsigned int index, const std::string_view& value)  
 {
-    sqlite3_bind_text(_stmt.get(), index + 1, value.data(), value.size(), SQLITE_TRANSIENT);
+    rewind();
+    sqlite3_bind_text64(_stmt.get(), index + 1, value.data(), value.size(), SQLITE_TRANSIENT, SQLITE_UTF8);
     // TODO process error, throw exception
     return *this;
 }
 
 statement& statement::bind(unsigned int index, const blob& value)  
 {
-    sqlite3_bind_blob(_stmt.get(), index + 1, value.data(), value.size(), SQLITE_TRANSIENT);
+    rewind();
+    sqlite3_bind_blob64(_stmt.get(), index + 1, value.data(), value.size(), SQLITE_TRANSIENT);
     // TODO process error, throw exception
     return *this;
 }
 
 statement& statement::bind(unsigned int index, bool value)
 {
+    rewind();
     sqlite3_bind_int(_stmt.get(), index + 1, value ? 1 : 0);
     // TODO process error, throw exception
     return *this;
@@ -647,6 +819,7 @@ statement& statement::bind(unsigned int index, bool value)
 
 statement& statement::bind(unsigned int index, int value)
 {
+    rewind();
     sqlite3_bind_int(_stmt.get(), index + 1, value);
     // TODO process error, throw exception
     return *this;
@@ -654,6 +827,7 @@ statement& statement::bind(unsigned int index, int value)
 
 statement& statement::bind(unsigned int index, int64_t value)  
 {
+    rewind();
     sqlite3_bind_int64(_stmt.get(), index + 1, value);
     // TODO process error, throw exception
     return *this;
@@ -661,6 +835,7 @@ statement& statement::bind(unsigned int index, int64_t value)
 
 statement& statement::bind(unsigned int index, double value)  
 {
+    rewind();
     sqlite3_bind_double(_stmt.get(), index + 1, value);
     // TODO process error, throw exception
     return *this;
@@ -668,12 +843,29 @@ statement& statement::bind(unsigned int index, double value)
 
 statement& statement::bind(unsigned int index, const value& value)  
 {
+    rewind();
     std::visit([&](auto&& arg) {
         bind(index, arg);
     }, value);
     return *this;
 }
 
+statement& statement::bind_ref(unsigned int index, const std::string_view& value)
+{
+    rewind();
+    sqlite3_bind_text64(_stmt.get(), index + 1, value.data(), value.size(), SQLITE_STATIC, SQLITE_UTF8);
+    // TODO process error, throw exception
+    return *this;
+}
+
+statement& statement::bind_ref(unsigned int index, const blob_span& value)
+{
+    rewind();
+    sqlite3_bind_blob64(_stmt.get(), index + 1, value.data(), value.size(), SQLITE_STATIC);
+    // TODO process error, throw exception
+    return *this;
+}
+
 //
 // SQLite's connection
 //
@@ -685,6 +877,8 @@ _db(db)
 
 connection::~connection()
 {
+    // Cached statements must be finalized before closing
+    clear_statement_cache();
     if(_db) {
         sqlite3_close(_db);
         _db = nullptr;
@@ -705,6 +899,7 @@ std::shared_ptr<connection> connection::create(const std::string& connection_str
 
 std::shared_ptr<stats_result> connection::execute(const std::string& query)
 {
+    std::shared_ptr<details::query_observation> observation = observe(query);
     sqlite3_int64 total_before = sqlite3_total_changes64(_db);
 
     char* err_msg = nullptr;
@@ -718,12 +913,16 @@ std::shared_ptr<stats_result> connection::execute(const std::string& query)
     sqlite3_int64 last_inserted_id = sqlite3_last_insert_rowid(_db);
     sqlite3_int64 change_count = sqlite3_changes64(_db);
     sqlite3_int64 total_after = sqlite3_total_changes64(_db);
+    if (observation) {
+        observation->executed(false);
+    }
 
     return std::make_shared<details::simple_stats_result>(change_count != 0 ? change_count : (total_after - total_before) , last_inserted_id);
 }
 
 std::shared_ptr<sqlcpp::statement> connection::prepare(const std::string& query)
 {
+    std::shared_ptr<details::query_observation> observation = observe(query);
     int rc;
     sqlite3_stmt* res;
     rc = sqlite3_prepare_v2(_db, query.c_str(), query.size(), &res, 0);
@@ -732,7 +931,16 @@ std::shared_ptr<sqlcpp::statement> connection::prepare(const std::string& query)
         // TODO throw exception
         return {};
     }
-    return std::make_shared<statement>(res);
+    auto stmt = std::make_shared<statement>(res);
+    if (observation) {
+        observation->prepared(*stmt);
+    }
+    return stmt;
+}
+
+bool connection::is_valid()
+{
+    return _db != nullptr;
 }
 
 //
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2024-2025 Emilien Kia <emilien.kia+dev@gmail.com>
+ *
+ * sqlcpp is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlcpp is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.";
+ */
+#include "catch.hpp"
+
+#include "sqlcpp/details.hpp"
+
+TEST_CASE("Hex codecs", "[hex]") {
+    // Sizes around the vector block sizes, all byte values
+    sqlcpp::blob data(200);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<unsigned char>(i * 37 + 11);
+    }
+
+    SECTION("Encode") {
+        REQUIRE( sqlcpp::details::blob_to_hex_string({}) == "" );
+        REQUIRE( sqlcpp::details::blob_to_hex_string({0x00, 0x09, 0x0a, 0x7f, 0x80, 0xa5, 0xff}) == "00090a7f80a5ff" );
+
+        static const char hex_digits[] = "0123456789abcdef";
+        for (size_t size : {1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 200}) {
+            sqlcpp::blob part(data.begin(), data.begin() + size);
+            std::string expected;
+            for (unsigned char c : part) {
+                expected.push_back(hex_digits[c >> 4]);
+                expected.push_back(hex_digits[c & 0x0F]);
+            }
+            REQUIRE( sqlcpp::details::blob_to_hex_string(part) == expected );
+        }
+    }
+
+    SECTION("Decode") {
+        for (size_t size : {0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 200}) {
+            sqlcpp::blob part(data.begin(), data.begin() + size);
+            std::string hex = sqlcpp::details::blob_to_hex_string(part);
+            sqlcpp::blob res(size);
+            REQUIRE( sqlcpp::details::hex_decode(hex, res.data()) );
+            REQUIRE( res == part );
+        }
+
+        // Upper and mixed case digits
+        std::string upper;
+        for (int i = 0; i < 4; ++i) {
+            upper += "0123456789ABCDEFabcdef0123456789";
+        }
+        sqlcpp::blob res(upper.size() / 2);
+        REQUIRE( sqlcpp::details::hex_decode(upper, res.data()) );
+        REQUIRE( res[5] == 0xAB );
+        REQUIRE( res[7] == 0xEF );
+        REQUIRE( res[8] == 0xAB );
+        REQUIRE( res[63] == 0x89 );
+    }
+
+    SECTION("Decode invalid") {
+        unsigned char res[64];
+        REQUIRE( !sqlcpp::details::hex_decode("abc", res) );
+
+        // Invalid characters are detected at any position of vector blocks and tails
+        std::string hex = sqlcpp::details::blob_to_hex_string(sqlcpp::blob(data.begin(), data.begin() + 64));
+        for (size_t i = 0; i < hex.size(); ++i) {
+            for (char c : {'g', 'G', '/', ':', '@', '`', ' ', '\0', '\xff', '\x80'}) {
+                std::string bad = hex;
+                bad[i] = c;
+                REQUIRE( !sqlcpp::details::hex_decode(bad, res) );
+            }
+        }
+    }
+
+    SECTION("Bytea escape format") {
+        sqlcpp::blob res;
+        REQUIRE( sqlcpp::details::bytea_unescape("", res) );
+        REQUIRE( res.empty() );
+
+        REQUIRE( sqlcpp::details::bytea_unescape("Hello", res) );
+        REQUIRE( res == sqlcpp::blob{'H', 'e', 'l', 'l', 'o'} );
+
+        REQUIRE( sqlcpp::details::bytea_unescape("a\\\\b\\000\\377\\101end", res) );
+        REQUIRE( res == sqlcpp::blob{'a', '\\', 'b', 0x00, 0xff, 'A', 'e', 'n', 'd'} );
+
+        REQUIRE( !sqlcpp::details::bytea_unescape("a\\", res) );
+        REQUIRE( !sqlcpp::details::bytea_unescape("\\x", res) );
+        REQUIRE( !sqlcpp::details::bytea_unescape("\\40", res) );
+        REQUIRE( !sqlcpp::details::bytea_unescape("\\400", res) );
+        REQUIRE( !sqlcpp::details::bytea_unescape("\\08", res) );
+    }
+}
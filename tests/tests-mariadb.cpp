@@ -267,6 +267,68 @@ TEST_CASE("Simple MariaDB", "[mariadb]")
         }
     }
 
+    SECTION("Typed execution"){
+        auto stmt = db->prepare("SELECT int64_val, text_val, double_val, blob_val, bool_val FROM test ORDER BY id");
+        REQUIRE( !!stmt );
+
+        auto tuples = stmt->execute_as<std::tuple<int64_t, std::string, double, std::optional<sqlcpp::blob>, std::optional<bool>>>();
+        REQUIRE( tuples.has_value() );
+        REQUIRE( tuples->size() == 3 );
+        REQUIRE( std::get<0>((*tuples)[0]) == 1 );
+        REQUIRE( std::get<1>((*tuples)[0]) == "Hello" );
+        REQUIRE( std::get<2>((*tuples)[0]) == 2.0 );
+        REQUIRE( std::get<3>((*tuples)[0]) == sqlcpp::blob{0x01, 0x02, 0x03, 0x04, 0x61, 0x62, 0x63, 0x64} );
+        REQUIRE( std::get<4>((*tuples)[0]) == true );
+        REQUIRE( std::get<4>((*tuples)[1]) == false );
+        REQUIRE( !std::get<3>((*tuples)[2]).has_value() );
+        REQUIRE( !std::get<4>((*tuples)[2]).has_value() );
+
+        struct record {
+            int64_t id;
+            std::string_view text;
+            double value;
+            sqlcpp::blob_span data;
+            std::optional<bool> flag;
+        };
+        std::vector<std::string> texts;
+        REQUIRE( stmt->execute_as<record>([&](const record& rec) {
+            texts.emplace_back(rec.text);
+        }) );
+        REQUIRE( texts == std::vector<std::string>{"Hello", "World", "!!!"} );
+
+        // Columns must match the fields
+        REQUIRE( !stmt->execute_as<std::tuple<int64_t, std::string>>().has_value() );
+    }
+
+    SECTION("Batch fetch") {
+        auto stmt = db->prepare("SELECT int64_val, double_val, NULLIF(int64_val, 2) FROM test ORDER BY id");
+        REQUIRE( !!stmt );
+
+        int64_t ints[2];
+        double doubles[2];
+        double nullable[2];
+        uint8_t validity[1];
+        std::vector<sqlcpp::batch_column> columns = {
+            {0, sqlcpp::span<int64_t>(ints, 2)},
+            {1, sqlcpp::span<double>(doubles, 2)},
+            {2, sqlcpp::span<double>(nullable, 2), sqlcpp::span<uint8_t>(validity, 1)},
+        };
+
+        auto rset = stmt->execute();
+        REQUIRE( rset->fetch_batch(columns) == 2 );
+        REQUIRE( ints[0] == 1 );
+        REQUIRE( ints[1] == 2 );
+        REQUIRE( doubles[1] == 4.0 );
+        REQUIRE( nullable[0] == 1.0 );
+        REQUIRE( (validity[0] & 0x03) == 0x01 );
+
+        REQUIRE( rset->fetch_batch(columns) == 1 );
+        REQUIRE( ints[0] == 3 );
+        REQUIRE( doubles[0] == 8.0 );
+
+        REQUIRE( rset->fetch_batch(columns) == 0 );
+    }
+
     // Cleanup
     db->execute("DROP TABLE test;");
 
@@ -347,6 +409,34 @@ TEST_CASE("MariaDB Variable Binding", "[mariadb][binding]")
         REQUIRE( std::holds_alternative<std::nullptr_t>(row.get_value(3)) );
     }
 
+    SECTION("Bind by reference")
+    {
+        auto stmt = db->prepare("INSERT INTO binding_test(int_val, text_val, blob_val) VALUES(?, ?, ?)");
+        REQUIRE( !!stmt );
+
+        std::string text = "first";
+        sqlcpp::blob data = {1, 2, 3};
+        stmt->bind(1, (int64_t)1);
+        stmt->bind_ref(2, std::string_view(text));
+        stmt->bind_ref(3, sqlcpp::blob_span(data));
+        stmt->execute();
+
+        // Referenced values are read at execution
+        text = "other";
+        data[0] = 9;
+        stmt->bind(1, (int64_t)2);
+        stmt->execute();
+
+        auto select_stmt = db->prepare("SELECT text_val, blob_val FROM binding_test ORDER BY int_val");
+        auto rset = select_stmt->execute_buffered();
+        REQUIRE( !!rset );
+        REQUIRE( rset->row_count() == 2 );
+        REQUIRE( rset->get_row(0).get_value_string(0) == "first" );
+        REQUIRE( rset->get_row(0).get_value_blob(1) == sqlcpp::blob{1, 2, 3} );
+        REQUIRE( rset->get_row(1).get_value_string(0) == "other" );
+        REQUIRE( rset->get_row(1).get_value_blob(1) == sqlcpp::blob{9, 2, 3} );
+    }
+
     SECTION("Multiple executions with different bindings")
     {
         auto stmt = db->prepare("INSERT INTO binding_test(int_val, text_val) VALUES(?, ?)");
@@ -374,6 +464,247 @@ TEST_CASE("MariaDB Variable Binding", "[mariadb][binding]")
         REQUIRE( row.get_value_int64(0) == 2 );
     }
 
+    SECTION("Array binding")
+    {
+        const size_t count = 1000;
+        std::vector<int64_t> ints(count);
+        std::vector<double> reals(count);
+        std::vector<std::string> texts(count);
+        std::vector<uint8_t> text_nulls(count, 0);
+        for (size_t i = 0; i < count; ++i) {
+            ints[i] = i + 1;
+            reals[i] = i * 0.5;
+            texts[i] = "row" + std::to_string(i);
+            text_nulls[i] = i % 10 == 0;
+        }
+
+        auto stmt = db->prepare("INSERT INTO binding_test(int_val, real_val, text_val) VALUES(?, ?, ?)");
+        REQUIRE( !!stmt );
+        stmt->bind_array(1, sqlcpp::span<const int64_t>(ints));
+        stmt->bind_array(2, sqlcpp::span<const double>(reals));
+        stmt->bind_array(3, sqlcpp::span<const std::string>(texts), text_nulls);
+        auto res = stmt->execute_array();
+        REQUIRE( !!res );
+        REQUIRE( res->affected_rows() == count );
+
+        auto select_stmt = db->prepare("SELECT COUNT(*), SUM(int_val), COUNT(text_val) FROM binding_test");
+        REQUIRE( !!select_stmt );
+        auto rset = select_stmt->execute_buffered();
+        REQUIRE( !!rset );
+        REQUIRE( rset->get_row(0).get_value_int64(0) == count );
+        REQUIRE( rset->get_row(0).get_value_int64(1) == count * (count + 1) / 2 );
+        REQUIRE( rset->get_row(0).get_value_int64(2) == count - count / 10 );
+
+        // Arrays must have the same size
+        std::vector<int64_t> shorter(count - 1);
+        stmt->bind_array(1, sqlcpp::span<const int64_t>(shorter));
+        REQUIRE( !stmt->execute_array() );
+
+        // Arrays are unbound by reset
+        stmt->reset();
+        REQUIRE( !stmt->execute_array() );
+    }
+
+    SECTION("Bulk execution of all types")
+    {
+        bool bools[] = {true, false, true};
+        int64_t ints[] = {100, 200, 300};
+        std::string_view texts[] = {"a", "bb", "ccc"};
+        sqlcpp::blob blobs[] = {{0x01}, {}, {0x02, 0x03}};
+        uint8_t blob_nulls[] = {0, 1, 0};
+
+        auto stmt = db->prepare("INSERT INTO binding_test(bool_val, int_val, text_val, blob_val) VALUES(?, ?, ?, ?)");
+        REQUIRE( !!stmt );
+        stmt->bind_array(1, sqlcpp::span<const bool>(bools, 3));
+        stmt->bind_array(2, sqlcpp::span<const int64_t>(ints, 3));
+        stmt->bind_array(3, sqlcpp::span<const std::string_view>(texts, 3));
+        stmt->bind_array(4, sqlcpp::span<const sqlcpp::blob>(blobs, 3), sqlcpp::span<const uint8_t>(blob_nulls, 3));
+        auto res = stmt->execute_array();
+        REQUIRE( !!res );
+        REQUIRE( res->affected_rows() == 3 );
+
+        // Scalar parameters are still usable after a bulk execution
+        stmt->reset();
+        stmt->bind(2, static_cast<int64_t>(400));
+        REQUIRE( !!stmt->execute() );
+
+        auto select_stmt = db->prepare("SELECT int_val, bool_val, text_val, blob_val FROM binding_test ORDER BY int_val");
+        auto rset = select_stmt->execute_buffered();
+        REQUIRE( !!rset );
+        REQUIRE( rset->row_count() == 4 );
+        REQUIRE( rset->get_row(0).get_value_bool(1) );
+        REQUIRE( rset->get_row(1).get_value_string(2) == "bb" );
+        REQUIRE( std::holds_alternative<std::nullptr_t>(rset->get_row(1).get_value(3)) );
+        REQUIRE( rset->get_row(2).get_value_blob(3) == sqlcpp::blob{0x02, 0x03} );
+        REQUIRE( std::holds_alternative<std::nullptr_t>(rset->get_row(3).get_value(2)) );
+    }
+
+    SECTION("Row by row array execution is transactional")
+    {
+        // A scalar parameter prevents bulk execution, rows are executed one by one
+        std::vector<int64_t> ids = {1, 2, 2};
+        auto stmt = db->prepare("INSERT INTO binding_test(id, text_val) VALUES(?, ?)");
+        REQUIRE( !!stmt );
+        stmt->bind_array(1, sqlcpp::span<const int64_t>(ids));
+        stmt->bind(2, std::string("scalar"));
+        REQUIRE( !stmt->execute_array() );
+
+        // The duplicate id fails the last row, previous ones are rolled back
+        auto select_stmt = db->prepare("SELECT COUNT(*) FROM binding_test");
+        REQUIRE( !!select_stmt );
+        REQUIRE( select_stmt->execute_buffered()->get_row(0).get_value_int64(0) == 0 );
+
+        ids[2] = 3;
+        auto res = stmt->execute_array();
+        REQUIRE( !!res );
+        REQUIRE( res->affected_rows() == 3 );
+        REQUIRE( select_stmt->execute_buffered()->get_row(0).get_value_int64(0) == 3 );
+    }
+
+    SECTION("Reset and re-execution")
+    {
+        auto stmt = db->prepare("INSERT INTO binding_test(int_val, text_val) VALUES(?, ?)");
+        REQUIRE( !!stmt );
+        for (int64_t i = 1; i <= 20; ++i) {
+            stmt->bind(1, i);
+            stmt->bind(2, std::string("loop"));
+            stmt->execute();
+        }
+
+        // Bindings are cleared (NULL) by reset
+        stmt->reset();
+        stmt->bind(2, std::string("reset"));
+        stmt->execute();
+
+        auto select_stmt = db->prepare("SELECT int_val FROM binding_test WHERE text_val = ? ORDER BY int_val");
+        REQUIRE( !!select_stmt );
+        select_stmt->bind(1, std::string("loop"));
+        int64_t sum = 0;
+        select_stmt->execute([&](const sqlcpp::row_base& row) {
+            sum += row.get_value_int64(0);
+        });
+        REQUIRE( sum == 210 );
+
+        // Partially consumed results are dropped by a new execution
+        {
+            auto rset = select_stmt->execute();
+            REQUIRE( !!rset );
+            auto it = rset->begin();
+            REQUIRE( (*it).get_value_int64(0) == 1 );
+            ++it;
+            REQUIRE( (*it).get_value_int64(0) == 2 );
+        }
+        auto rset = select_stmt->execute();
+        REQUIRE( !!rset );
+        REQUIRE( (*rset->begin()).get_value_int64(0) == 1 );
+
+        // Statements do not close each other
+        auto other = db->prepare("SELECT COUNT(*) FROM binding_test");
+        REQUIRE( !!other );
+        auto other_rset = other->execute();
+        REQUIRE( !!other_rset );
+        REQUIRE( (*other_rset->begin()).get_value_int64(0) >= 21 );
+
+        select_stmt->reset();
+        select_stmt->bind(1, std::string("reset"));
+        auto buffered = select_stmt->execute_buffered();
+        REQUIRE( !!buffered );
+        REQUIRE( buffered->row_count() == 1 );
+        REQUIRE( std::holds_alternative<std::nullptr_t>(buffered->get_row(0).get_value(0)) );
+    }
+
+    SECTION("Server-side cursor")
+    {
+        auto insert_stmt = db->prepare("INSERT INTO binding_test(int_val, text_val) VALUES(?, ?)");
+        REQUIRE( !!insert_stmt );
+        std::vector<int64_t> values(100);
+        for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = i + 1;
+        }
+        insert_stmt->bind_array(1, sqlcpp::span<const int64_t>(values));
+        insert_stmt->bind(2, std::string("cursor"));
+        REQUIRE( !!insert_stmt->execute_array() );
+
+        db->cursor_prefetch_rows(7);
+        REQUIRE( db->cursor_prefetch_rows() == 7 );
+        auto select_stmt = db->prepare("SELECT int_val FROM binding_test WHERE text_val = 'cursor' ORDER BY int_val");
+        REQUIRE( !!select_stmt );
+        db->cursor_prefetch_rows(0);
+
+        auto rset = select_stmt->execute();
+        REQUIRE( !!rset );
+        auto count_stmt = db->prepare("SELECT COUNT(*) FROM binding_test WHERE text_val = 'cursor'");
+        REQUIRE( !!count_stmt );
+
+        // The open cursor survives other statements and queries between fetches
+        int64_t expected = 1;
+        for (auto& row : *rset) {
+            REQUIRE( row.get_value_int64(0) == expected );
+            if (expected % 10 == 0) {
+                REQUIRE( (*count_stmt->execute()->begin()).get_value_int64(0) == 100 );
+                db->execute("SELECT 1");
+            }
+            ++expected;
+        }
+        REQUIRE( expected == 101 );
+    }
+
+    SECTION("Values larger than result buffers")
+    {
+        std::string short_text = "short";
+        std::string long_text(10000, 'x');
+        sqlcpp::blob long_blob(5000, 0x5a);
+
+        auto insert_stmt = db->prepare("INSERT INTO binding_test(int_val, text_val, blob_val) VALUES(?, ?, ?)");
+        REQUIRE( !!insert_stmt );
+        insert_stmt->bind(1, (int64_t)1);
+        insert_stmt->bind(2, short_text);
+        insert_stmt->bind(3, sqlcpp::blob{1, 2, 3});
+        insert_stmt->execute();
+        insert_stmt->bind(1, (int64_t)2);
+        insert_stmt->bind(2, long_text);
+        insert_stmt->bind(3, long_blob);
+        insert_stmt->execute();
+        insert_stmt->bind(1, (int64_t)3);
+        insert_stmt->bind(2, short_text);
+        insert_stmt->bind(3, nullptr);
+        insert_stmt->execute();
+
+        auto stmt = db->prepare("SELECT text_val, blob_val FROM binding_test ORDER BY int_val");
+        REQUIRE( !!stmt );
+
+        // Truncated values are fetched again in grown buffers
+        auto rset = stmt->execute();
+        REQUIRE( !!rset );
+        auto it = rset->begin();
+        REQUIRE( (*it).get_value_string(0) == short_text );
+        ++it;
+        REQUIRE( (*it).get_value_string(0) == long_text );
+        REQUIRE( (*it).get_value_blob(1) == long_blob );
+        ++it;
+        REQUIRE( (*it).get_value_string(0) == short_text );
+        REQUIRE( std::holds_alternative<std::nullptr_t>((*it).get_value(1)) );
+
+        auto buffered = stmt->execute_buffered();
+        REQUIRE( !!buffered );
+        REQUIRE( buffered->row_count() == 3 );
+        REQUIRE( buffered->get_row(1).get_value_string(0) == long_text );
+        REQUIRE( buffered->get_row(0).get_value_blob(1) == sqlcpp::blob{1, 2, 3} );
+
+        size_t count = 0;
+        for (const auto& row : *buffered) {
+            REQUIRE( row.get_value_string(0) == (count == 1 ? long_text : short_text) );
+            ++count;
+        }
+        REQUIRE( count == 3 );
+
+        size_t total = 0;
+        stmt->execute([&](const sqlcpp::row_base& row) {
+            total += row.get_value_string(0).size();
+        });
+        REQUIRE( total == long_text.size() + 2 * short_text.size() );
+    }
+
     // Cleanup
 //    db->execute("DROP TABLE binding_test;");
 }
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2024-2025 Emilien Kia <emilien.kia+dev@gmail.com>
+ *
+ * sqlcpp is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * sqlcpp is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.";
+ */
+#include "catch.hpp"
+
+#include "sqlcpp/pool.hpp"
+#include "sqlcpp/sqlite.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+TEST_CASE("Connection pool", "[pool][sqlite]") {
+    std::atomic<int> opened{0};
+    auto factory = [&opened]() -> std::shared_ptr<sqlcpp::connection> {
+        ++opened;
+        return sqlcpp::sqlite::connection::create(":memory:");
+    };
+
+    sqlcpp::connection_pool_options options;
+    options.max_size = 2;
+    options.checkout_timeout = std::chrono::milliseconds(50);
+
+    SECTION("Leases give connections back to the pool") {
+        auto pool = sqlcpp::connection_pool::create(factory, options);
+        REQUIRE( !!pool );
+        REQUIRE( pool->size() == 0 );
+
+        sqlcpp::connection* first = nullptr;
+        {
+            auto lease = pool->acquire();
+            REQUIRE( !!lease );
+            REQUIRE( !!lease->execute("CREATE TABLE test (id INTEGER);") );
+            first = lease.get().get();
+            REQUIRE( pool->size() == 1 );
+            REQUIRE( pool->idle_count() == 0 );
+        }
+        REQUIRE( pool->idle_count() == 1 );
+
+        auto lease = pool->acquire();
+        REQUIRE( lease.get().get() == first );
+        REQUIRE( opened == 1 );
+        // Same connection, so same in-memory database
+        REQUIRE( !!lease->prepare("SELECT * FROM test") );
+    }
+
+    SECTION("Checkout times out when the pool is exhausted") {
+        auto pool = sqlcpp::connection_pool::create(factory, options);
+        auto first = pool->acquire();
+        auto second = pool->acquire();
+        REQUIRE( !!first );
+        REQUIRE( !!second );
+        REQUIRE( pool->size() == 2 );
+
+        REQUIRE( !pool->try_acquire() );
+        auto start = std::chrono::steady_clock::now();
+        REQUIRE( !pool->acquire() );
+        REQUIRE( std::chrono::steady_clock::now() - start >= options.checkout_timeout );
+
+        sqlcpp::connection* released = second.get().get();
+        second.release();
+        REQUIRE( !second );
+        auto third = pool->try_acquire();
+        REQUIRE( third.get().get() == released );
+        REQUIRE( opened == 2 );
+    }
+
+    SECTION("Waiting checkouts are served by released leases") {
+        auto pool = sqlcpp::connection_pool::create(factory, options);
+        auto first = pool->acquire();
+        auto second = pool->acquire();
+
+        std::thread releaser([&second]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            second.release();
+        });
+        auto third = pool->acquire(std::chrono::seconds(5));
+        releaser.join();
+        REQUIRE( !!third );
+        REQUIRE( opened == 2 );
+    }
+
+    SECTION("Invalidated connections are closed") {
+        auto pool = sqlcpp::connection_pool::create(factory, options);
+        auto lease = pool->acquire();
+        lease.invalidate();
+        REQUIRE( !lease );
+        REQUIRE( pool->size() == 0 );
+        REQUIRE( pool->idle_count() == 0 );
+
+        REQUIRE( !!pool->acquire() );
+        REQUIRE( opened == 2 );
+    }
+
+    SECTION("Minimum size and idle eviction") {
+        options.min_size = 1;
+        options.idle_timeout = std::chrono::milliseconds(1);
+        auto pool = sqlcpp::connection_pool::create(factory, options);
+        REQUIRE( pool->size() == 1 );
+        REQUIRE( pool->idle_count() == 1 );
+        REQUIRE( opened == 1 );
+
+        {
+            auto first = pool->acquire();
+            auto second = pool->acquire();
+            REQUIRE( pool->size() == 2 );
+        }
+        REQUIRE( pool->idle_count() == 2 );
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        pool->evict_idle();
+        REQUIRE( pool->size() == 1 );
+        REQUIRE( pool->idle_count() == 1 );
+    }
+
+    SECTION("Throwing factories release their slot") {
+        std::atomic<int> failures{3};
+        auto throwing = [&]() -> std::shared_ptr<sqlcpp::connection> {
+            if (failures > 0) {
+                --failures;
+                throw std::runtime_error("Server unavailable");
+            }
+            return factory();
+        };
+        options.min_size = 1;
+        auto pool = sqlcpp::connection_pool::create(throwing, options);
+        REQUIRE( !!pool );
+        REQUIRE( pool->size() == 0 );
+
+        // More failures than slots, no slot must stay reserved
+        REQUIRE_THROWS_AS( pool->acquire(), std::runtime_error );
+        REQUIRE_THROWS_AS( pool->acquire(), std::runtime_error );
+        REQUIRE( pool->size() == 0 );
+
+        auto first = pool->try_acquire();
+        auto second = pool->try_acquire();
+        REQUIRE( !!first );
+        REQUIRE( !!second );
+        REQUIRE( pool->size() == 2 );
+    }
+
+    SECTION("Leases keep their pool alive") {
+        auto pool = sqlcpp::connection_pool::create(factory, options);
+        auto lease = pool->acquire();
+        std::weak_ptr<sqlcpp::connection_pool> weak = pool;
+        pool.reset();
+        REQUIRE( !weak.expired() );
+        lease.release();
+        REQUIRE( weak.expired() );
+    }
+
+    SECTION("Concurrent leases") {
+        options.max_size = 4;
+        options.checkout_timeout = std::chrono::seconds(5);
+        auto pool = sqlcpp::connection_pool::create(factory, options);
+
+        std::atomic<int> leased{0};
+        std::atomic<int> max_leased{0};
+        std::atomic<int> failed{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < 50; ++i) {
+                    auto lease = pool->acquire();
+                    if (!lease || !lease->execute("SELECT 1;")) {
+                        ++failed;
+                        continue;
+                    }
+                    int current = ++leased;
+                    int expected = max_leased;
+                    while (current > expected && !max_leased.compare_exchange_weak(expected, current)) {}
+                    --leased;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE( failed == 0 );
+        REQUIRE( max_leased <= 4 );
+        REQUIRE( pool->size() <= 4 );
+        REQUIRE( opened <= 4 );
+    }
+}
+
+TEST_CASE("Connection pool from connection string", "[pool][factory][sqlite]") {
+    auto pool = sqlcpp::connection_pool::create("sqlite::memory:");
+    REQUIRE( !!pool );
+    auto lease = pool->acquire();
+    REQUIRE( !!lease );
+    REQUIRE( !!lease->execute("CREATE TABLE test (id INTEGER);") );
+
+    auto invalid = sqlcpp::connection_pool::create("toto:memory:");
+    REQUIRE( !invalid->acquire() );
+    REQUIRE( invalid->size() == 0 );
+}
@@ -20,6 +20,7 @@
 #include "sqlcpp/postgresql.hpp"
 
 #include <iostream>
+#include <stdexcept>
 
 #include "sqlcpp/details.hpp"
 
@@ -272,6 +273,210 @@ TEST_CASE("Simple PostgreSQL", "[postgresql]")
         }
     }
 
+    // Binary result format
+    SECTION("Binary result format"){
+        db->binary_results(true);
+        auto stmt = db->prepare("SELECT * FROM test ORDER BY id");
+        REQUIRE( !!stmt );
+
+        auto rset = stmt->execute();
+        REQUIRE( !!rset );
+
+        auto it = rset->begin();
+
+        {
+            auto& row = *it;
+            REQUIRE( std::holds_alternative<int>(row.get_value(0)) );
+            REQUIRE( std::holds_alternative<int64_t>(row.get_value(1)) );
+            REQUIRE( std::holds_alternative<double>(row.get_value(2)) );
+            REQUIRE( std::holds_alternative<std::string>(row.get_value(3)) );
+            REQUIRE( std::holds_alternative<sqlcpp::blob>(row.get_value(4)) );
+            REQUIRE( std::holds_alternative<bool>(row.get_value(5)) );
+
+            REQUIRE( row.get_value_int(0) == 1 );
+            REQUIRE( row.get_value_int64(1) == 1 );
+            REQUIRE( row.get_value_double(2) == 2.0 );
+            REQUIRE( row.get_value_string(3) == "Hello" );
+            REQUIRE( row.get_value_blob(4) == sqlcpp::blob{0x01, 0x02, 0x03, 0x04, 0x61, 0x62, 0x63, 0x64} );
+            REQUIRE( row.get_value_bool(5) == true );
+            REQUIRE( row.get_value_string(1) == "1" );
+        }
+
+        {
+            auto& row = *++it;
+
+            REQUIRE( row.get_value_int(0) == 2 );
+            REQUIRE( row.get_value_int64(1) == 2 );
+            REQUIRE( row.get_value_double(2) == 4.0 );
+            REQUIRE( row.get_value_string(3) == "World" );
+            REQUIRE( row.get_value_blob(4) == sqlcpp::blob{'H','e','l','l','o'} );
+            REQUIRE( row.get_value_bool(5) == false );
+        }
+
+        {
+            auto& row = *++it;
+
+            REQUIRE( row.get_value_int(0) == 3 );
+            REQUIRE( std::holds_alternative<std::nullptr_t >(row.get_value(4)) );
+            REQUIRE( std::holds_alternative<std::nullptr_t >(row.get_value(5)) );
+        }
+        db->binary_results(false);
+    }
+
+    SECTION("Cached statements follow the result format"){
+        const std::string query = "SELECT int64 FROM test WHERE id = 1";
+        auto text_stmt = db->prepare_cached(query);
+        REQUIRE( !!text_stmt );
+        REQUIRE( db->prepare_cached(query) == text_stmt );
+        REQUIRE( text_stmt->execute_buffered()->get_row(0).get_value_int64(0) == 1 );
+
+        // Changing the format clears the cache, the statement is prepared again in binary format
+        db->binary_results(true);
+        REQUIRE( db->statement_cache_size() == 0 );
+        auto binary_stmt = db->prepare_cached(query);
+        REQUIRE( !!binary_stmt );
+        REQUIRE( binary_stmt != text_stmt );
+        REQUIRE( binary_stmt->execute_buffered()->get_row(0).get_value_int64(0) == 1 );
+        REQUIRE( db->prepare_cached(query) == binary_stmt );
+
+        db->binary_results(false);
+        REQUIRE( db->statement_cache_size() == 0 );
+        REQUIRE( db->prepare_cached(query) != binary_stmt );
+    }
+
+    SECTION("Binary result format with non-decodable columns"){
+        db->binary_results(true);
+        auto stmt = db->prepare("SELECT int64, 1.5::NUMERIC, TIMESTAMP '2024-01-02 03:04:05', text FROM test WHERE id = 1");
+        REQUIRE( !!stmt );
+
+        auto rset = stmt->execute_buffered();
+        REQUIRE( !!rset );
+        REQUIRE( rset->row_count() == 1 );
+
+        const auto& row = rset->get_row(0);
+        REQUIRE( row.get_value_int64(0) == 1 );
+        REQUIRE( row.get_value_string(1) == "1.5" );
+        REQUIRE( row.get_value_string(2) == "2024-01-02 03:04:05" );
+        REQUIRE( row.get_value_string(3) == "Hello" );
+        db->binary_results(false);
+    }
+
+    // Streamed execution
+    SECTION("Streamed statement execution"){
+        db->streaming_rows(1);
+        auto stmt = db->prepare("SELECT * FROM test ORDER BY id");
+        REQUIRE( !!stmt );
+
+        {
+            auto rset = stmt->execute();
+            REQUIRE( !!rset );
+            REQUIRE( rset->has_row() );
+            REQUIRE( rset->column_count() == 6 );
+            REQUIRE( rset->column_type(1) == sqlcpp::value_type::INT64 );
+
+            int count = 0;
+            for (const sqlcpp::row& row : *rset) {
+                REQUIRE( row.get_value_int(0) == ++count );
+            }
+            REQUIRE( count == 3 );
+        }
+
+        {
+            // Abandoned before the end, the connection must be released
+            auto rset = stmt->execute();
+            REQUIRE( !!rset );
+            auto it = rset->begin();
+            REQUIRE( (*it).get_value_int(0) == 1 );
+        }
+
+        std::vector<sqlcpp::details::generic_row> results;
+        stmt->execute([&](const sqlcpp::row_base& row) {
+            results.emplace_back(row);
+        });
+        REQUIRE( results.size() == 3 );
+        REQUIRE( results[2].get_value_string(3) == "!!!" );
+
+        // A throwing callback cancels the query, the connection must be released
+        auto large = db->prepare("SELECT generate_series(1, 100000000)");
+        REQUIRE( !!large );
+        int received = 0;
+        REQUIRE_THROWS_AS( large->execute([&](const sqlcpp::row_base&) {
+            if(++received == 10) {
+                throw std::runtime_error("Stop");
+            }
+        }), std::runtime_error );
+        REQUIRE( received == 10 );
+        REQUIRE( !!db->execute("SELECT 1") );
+
+        db->streaming_rows(0);
+    }
+
+    SECTION("Typed execution"){
+        auto stmt = db->prepare("SELECT int64, text, double, blob, bool FROM test ORDER BY id");
+        REQUIRE( !!stmt );
+
+        auto tuples = stmt->execute_as<std::tuple<int64_t, std::string, double, std::optional<sqlcpp::blob>, std::optional<bool>>>();
+        REQUIRE( tuples.has_value() );
+        REQUIRE( tuples->size() == 3 );
+        REQUIRE( std::get<0>((*tuples)[0]) == 1 );
+        REQUIRE( std::get<1>((*tuples)[0]) == "Hello" );
+        REQUIRE( std::get<2>((*tuples)[0]) == 2.0 );
+        REQUIRE( std::get<3>((*tuples)[0]) == sqlcpp::blob{0x01, 0x02, 0x03, 0x04, 0x61, 0x62, 0x63, 0x64} );
+        REQUIRE( std::get<4>((*tuples)[0]) == true );
+        REQUIRE( std::get<4>((*tuples)[1]) == false );
+        REQUIRE( !std::get<3>((*tuples)[2]).has_value() );
+        REQUIRE( !std::get<4>((*tuples)[2]).has_value() );
+
+        struct record {
+            int64_t id;
+            std::string_view text;
+            double value;
+            sqlcpp::blob_span data;
+            std::optional<bool> flag;
+        };
+        std::vector<std::string> texts;
+        REQUIRE( stmt->execute_as<record>([&](const record& rec) {
+            texts.emplace_back(rec.text);
+        }) );
+        REQUIRE( texts == std::vector<std::string>{"Hello", "World", "!!!"} );
+
+        // Columns must match the fields
+        REQUIRE( !stmt->execute_as<std::tuple<int64_t, std::string>>().has_value() );
+    }
+
+    SECTION("Batch fetch") {
+        // Batches span several streamed chunks
+        db->streaming_rows(1);
+        auto stmt = db->prepare("SELECT int64, double, NULLIF(int64, 2)::FLOAT8 FROM test ORDER BY id");
+        REQUIRE( !!stmt );
+
+        int64_t ints[2];
+        double doubles[2];
+        double nullable[2];
+        uint8_t validity[1];
+        std::vector<sqlcpp::batch_column> columns = {
+            {0, sqlcpp::span<int64_t>(ints, 2)},
+            {1, sqlcpp::span<double>(doubles, 2)},
+            {2, sqlcpp::span<double>(nullable, 2), sqlcpp::span<uint8_t>(validity, 1)},
+        };
+
+        auto rset = stmt->execute();
+        REQUIRE( rset->fetch_batch(columns) == 2 );
+        REQUIRE( ints[0] == 1 );
+        REQUIRE( ints[1] == 2 );
+        REQUIRE( doubles[1] == 4.0 );
+        REQUIRE( nullable[0] == 1.0 );
+        REQUIRE( (validity[0] & 0x03) == 0x01 );
+
+        REQUIRE( rset->fetch_batch(columns) == 1 );
+        REQUIRE( ints[0] == 3 );
+        REQUIRE( doubles[0] == 8.0 );
+
+        REQUIRE( rset->fetch_batch(columns) == 0 );
+
+        db->streaming_rows(0);
+    }
+
     // Cleanup
     db->execute("DROP TABLE test;");
 }
@@ -418,6 +623,92 @@ TEST_CASE("PostgreSQL Variable Binding", "[postgresql][binding]")
         REQUIRE( row.get_value_int64(0) == 2 );
     }
 
+    SECTION("Array binding")
+    {
+        const size_t count = 1000;
+        std::vector<int64_t> ints(count);
+        std::vector<double> reals(count);
+        std::vector<std::string> texts(count);
+        std::vector<uint8_t> text_nulls(count, 0);
+        for (size_t i = 0; i < count; ++i) {
+            ints[i] = i + 1;
+            reals[i] = i * 0.5;
+            texts[i] = "row" + std::to_string(i);
+            text_nulls[i] = i % 10 == 0;
+        }
+
+        auto stmt = db->prepare("INSERT INTO binding_test(int_val, real_val, text_val) VALUES($1, $2, $3)");
+        REQUIRE( !!stmt );
+        stmt->bind_array(1, sqlcpp::span<const int64_t>(ints));
+        stmt->bind_array(2, sqlcpp::span<const double>(reals));
+        stmt->bind_array(3, sqlcpp::span<const std::string>(texts), text_nulls);
+        auto res = stmt->execute_array();
+        REQUIRE( !!res );
+        REQUIRE( res->affected_rows() == count );
+
+        auto select_stmt = db->prepare("SELECT COUNT(*), SUM(int_val), COUNT(text_val) FROM binding_test");
+        REQUIRE( !!select_stmt );
+        auto rset = select_stmt->execute_buffered();
+        REQUIRE( !!rset );
+        REQUIRE( rset->get_row(0).get_value_int64(0) == count );
+        REQUIRE( rset->get_row(0).get_value_int64(1) == count * (count + 1) / 2 );
+        REQUIRE( rset->get_row(0).get_value_int64(2) == count - count / 10 );
+
+        // Arrays must have the same size
+        std::vector<int64_t> shorter(count - 1);
+        stmt->bind_array(1, sqlcpp::span<const int64_t>(shorter));
+        REQUIRE( !stmt->execute_array() );
+
+        // Arrays are unbound by reset
+        stmt->reset();
+        REQUIRE( !stmt->execute_array() );
+    }
+
+    SECTION("Reset and re-execution")
+    {
+        auto stmt = db->prepare("INSERT INTO binding_test(int_val, text_val) VALUES($1, $2)");
+        REQUIRE( !!stmt );
+        for (int64_t i = 1; i <= 20; ++i) {
+            stmt->bind(1, i);
+            stmt->bind(2, std::string("loop"));
+            stmt->execute();
+        }
+
+        // Bindings are cleared (NULL) by reset
+        stmt->reset();
+        stmt->bind(2, std::string("reset"));
+        stmt->execute();
+
+        auto select_stmt = db->prepare("SELECT int_val FROM binding_test WHERE text_val = $1 ORDER BY int_val");
+        REQUIRE( !!select_stmt );
+        select_stmt->bind(1, std::string("loop"));
+        int64_t sum = 0;
+        select_stmt->execute([&](const sqlcpp::row_base& row) {
+            sum += row.get_value_int64(0);
+        });
+        REQUIRE( sum == 210 );
+
+        // Partially consumed results are dropped by a new execution
+        {
+            auto rset = select_stmt->execute();
+            REQUIRE( !!rset );
+            auto it = rset->begin();
+            REQUIRE( (*it).get_value_int64(0) == 1 );
+            ++it;
+            REQUIRE( (*it).get_value_int64(0) == 2 );
+        }
+        auto rset = select_stmt->execute();
+        REQUIRE( !!rset );
+        REQUIRE( (*rset->begin()).get_value_int64(0) == 1 );
+
+        select_stmt->reset();
+        select_stmt->bind(1, std::string("reset"));
+        auto buffered = select_stmt->execute_buffered();
+        REQUIRE( !!buffered );
+        REQUIRE( buffered->row_count() == 1 );
+        REQUIRE( std::holds_alternative<std::nullptr_t>(buffered->get_row(0).get_value(0)) );
+    }
+
     SECTION("Bind different integer types")
     {
         auto stmt = db->prepare("INSERT INTO binding_test(int_val) VALUES($1)");
@@ -448,6 +739,214 @@ TEST_CASE("PostgreSQL Variable Binding", "[postgresql][binding]")
         REQUIRE( row.get_value_int64(0) == 3 );
     }
 
+    SECTION("Bind in binary format")
+    {
+        db->binary_parameters(true);
+        auto stmt = db->prepare("INSERT INTO binding_test(int_val, real_val, text_val, blob_val, bool_val) VALUES($1, $2, $3, $4, $5)");
+        REQUIRE( !!stmt );
+
+        sqlcpp::blob data(1024 * 1024);
+        for(size_t i=0; i<data.size(); ++i) {
+            data[i] = (unsigned char) i;
+        }
+
+        stmt->bind(1, 200);
+        stmt->bind(2, 1.5);
+        stmt->bind(3, std::string("binary"));
+        stmt->bind(4, data);
+        stmt->bind(5, true);
+        REQUIRE( !!stmt->execute() );
+
+        stmt->bind(1, static_cast<int64_t>(201));
+        stmt->bind(4, sqlcpp::blob{});
+        stmt->bind_null(5);
+        REQUIRE( !!stmt->execute() );
+
+        auto select_stmt = db->prepare("SELECT int_val, real_val, text_val, blob_val, bool_val FROM binding_test WHERE int_val >= $1 ORDER BY int_val");
+        select_stmt->bind(1, static_cast<int64_t>(200));
+        auto rset = select_stmt->execute();
+        REQUIRE( !!rset );
+
+        auto it = rset->begin();
+        {
+            auto& row = *it;
+            REQUIRE( row.get_value_int64(0) == 200 );
+            REQUIRE( row.get_value_double(1) == 1.5 );
+            REQUIRE( row.get_value_string(2) == "binary" );
+            REQUIRE( row.get_value_blob(3) == data );
+            REQUIRE( row.get_value_bool(4) == true );
+            REQUIRE( row.get_value_string_view(2) == "binary" );
+            sqlcpp::blob_span view = row.get_value_blob_span(3);
+            REQUIRE( sqlcpp::blob(view.begin(), view.end()) == data );
+        }
+        {
+            auto& row = *++it;
+            REQUIRE( row.get_value_int64(0) == 201 );
+            REQUIRE( row.get_value_blob(3).empty() );
+            REQUIRE( std::holds_alternative<std::nullptr_t>(row.get_value(4)) );
+        }
+        db->binary_parameters(false);
+    }
+
+    SECTION("Array execution with binary parameters")
+    {
+        // Doubles are sent exactly in binary format, text format would round them
+        db->binary_parameters(true);
+        std::vector<int64_t> ints = {400, 401, 402};
+        std::vector<double> reals = {0.1234567891, 1.0 / 3.0, 2.5e-10};
+        auto stmt = db->prepare("INSERT INTO binding_test(int_val, real_val) VALUES($1, $2)");
+        REQUIRE( !!stmt );
+        stmt->bind_array(1, sqlcpp::span<const int64_t>(ints));
+        stmt->bind_array(2, sqlcpp::span<const double>(reals));
+        auto res = stmt->execute_array();
+        REQUIRE( !!res );
+        REQUIRE( res->affected_rows() == 3 );
+        db->binary_parameters(false);
+
+        auto select_stmt = db->prepare("SELECT real_val FROM binding_test WHERE int_val >= 400 ORDER BY int_val");
+        auto rset = select_stmt->execute_buffered();
+        REQUIRE( !!rset );
+        REQUIRE( rset->row_count() == 3 );
+        for(unsigned int i = 0; i < 3; ++i) {
+            REQUIRE( rset->get_row(i).get_value_double(0) == reals[i] );
+        }
+    }
+
+    SECTION("Pipelined executions")
+    {
+        auto stmt = db->prepare("INSERT INTO binding_test(int_val, text_val) VALUES($1, $2)");
+        REQUIRE( !!stmt );
+
+        {
+            auto pipe = db->start_pipeline(16);
+            REQUIRE( !!pipe );
+            for(int i=0; i<100; ++i) {
+                stmt->bind(1, 300 + i);
+                stmt->bind(2, "row " + std::to_string(i));
+                pipe->execute(*stmt);
+            }
+            auto results = pipe->sync();
+            REQUIRE( results.size() == 100 );
+            for(const auto& res : results) {
+                REQUIRE( !!res );
+                REQUIRE( res->affected_rows() == 1 );
+            }
+        }
+
+        auto select_stmt = db->prepare("SELECT COUNT(*), MAX(int_val) FROM binding_test WHERE int_val >= 300");
+        auto rset = select_stmt->execute();
+        REQUIRE( !!rset );
+        auto& row = *rset->begin();
+        REQUIRE( row.get_value_int64(0) == 100 );
+        REQUIRE( row.get_value_int64(1) == 399 );
+    }
+
+    SECTION("Bulk load with COPY")
+    {
+        {
+            auto writer = db->copy_from("binding_test", {"int_val", "real_val", "text_val", "blob_val", "bool_val"});
+            REQUIRE( !!writer );
+            REQUIRE( writer->binary() );
+            for(int i=0; i<1000; ++i) {
+                writer->write(500 + i, i * 0.5, "row\t" + std::to_string(i), sqlcpp::blob{0x00, (unsigned char) i}, i % 2 == 0);
+            }
+            writer->write_row({static_cast<int64_t>(1500), nullptr, std::string("last"), nullptr, nullptr});
+            // Unsigned and other integral types
+            writer->write(static_cast<size_t>(1502), 2u, std::string("unsigned"), nullptr, 1ull);
+            // Out of int64_t range, dropped
+            writer->write(std::numeric_limits<uint64_t>::max(), 1.0, nullptr, nullptr, nullptr);
+            // Invalid row, dropped
+            writer->write_row({static_cast<int64_t>(1501), 1.0});
+            auto stats = writer->finish();
+            REQUIRE( !!stats );
+            REQUIRE( stats->affected_rows() == 1002 );
+        }
+
+        auto select_stmt = db->prepare("SELECT int_val, real_val, text_val, blob_val, bool_val FROM binding_test WHERE int_val >= 500 ORDER BY int_val");
+        auto rset = select_stmt->execute();
+        REQUIRE( !!rset );
+        auto it = rset->begin();
+        {
+            auto& row = *++it;
+            REQUIRE( row.get_value_int64(0) == 501 );
+            REQUIRE( row.get_value_double(1) == 0.5 );
+            REQUIRE( row.get_value_string(2) == "row\t1" );
+            REQUIRE( row.get_value_blob(3) == sqlcpp::blob{0x00, 0x01} );
+            REQUIRE( row.get_value_bool(4) == false );
+        }
+        {
+            auto unsigned_stmt = db->prepare("SELECT real_val, text_val, bool_val FROM binding_test WHERE int_val = 1502");
+            auto unsigned_rset = unsigned_stmt->execute();
+            REQUIRE( !!unsigned_rset );
+            auto& row = *unsigned_rset->begin();
+            REQUIRE( row.get_value_double(0) == 2.0 );
+            REQUIRE( row.get_value_string(1) == "unsigned" );
+            REQUIRE( row.get_value_bool(2) == true );
+        }
+
+        // Unsupported column types fall back to text format
+        db->execute("CREATE TEMP TABLE copy_test (id INTEGER, amount NUMERIC, label TEXT, data BYTEA);");
+        {
+            auto writer = db->copy_from("copy_test");
+            REQUIRE( !!writer );
+            REQUIRE( !writer->binary() );
+            writer->write(1, "12.50", "back\\slash\nnew line", sqlcpp::blob{0xDE, 0xAD});
+            writer->write(2, nullptr, nullptr, nullptr);
+            auto stats = writer->finish();
+            REQUIRE( !!stats );
+            REQUIRE( stats->affected_rows() == 2 );
+        }
+        auto text_stmt = db->prepare("SELECT id, amount::TEXT, label, data FROM copy_test ORDER BY id");
+        auto text_rset = text_stmt->execute();
+        REQUIRE( !!text_rset );
+        auto& row = *text_rset->begin();
+        REQUIRE( row.get_value_string(1) == "12.50" );
+        REQUIRE( row.get_value_string(2) == "back\\slash\nnew line" );
+        REQUIRE( row.get_value_blob(3) == sqlcpp::blob{0xDE, 0xAD} );
+        db->execute("DROP TABLE copy_test;");
+    }
+
+    SECTION("Export with COPY")
+    {
+        auto stmt = db->prepare("INSERT INTO binding_test(int_val, real_val, text_val, blob_val, bool_val) VALUES($1, $2, $3, $4, $5)");
+        stmt->bind(1, 700).bind(2, 2.5).bind(3, std::string("tab\there")).bind(4, sqlcpp::blob{0x00, 0xFF}).bind(5, true);
+        REQUIRE( !!stmt->execute() );
+        stmt->bind(1, 701).bind_null(2).bind_null(3).bind_null(4).bind_null(5);
+        REQUIRE( !!stmt->execute() );
+
+        std::vector<sqlcpp::details::generic_row> rows;
+        auto stats = db->copy_to("SELECT int_val, real_val, text_val, blob_val, bool_val FROM binding_test WHERE int_val >= 700 ORDER BY int_val",
+            [&](const sqlcpp::row_base& row) {
+                rows.emplace_back(row);
+            });
+        REQUIRE( !!stats );
+        REQUIRE( stats->affected_rows() == 2 );
+        REQUIRE( rows.size() == 2 );
+        REQUIRE( rows[0].get_value_int64(0) == 700 );
+        REQUIRE( rows[0].get_value_double(1) == 2.5 );
+        REQUIRE( rows[0].get_value_string(2) == "tab\there" );
+        REQUIRE( rows[0].get_value_blob(3) == sqlcpp::blob{0x00, 0xFF} );
+        REQUIRE( rows[0].get_value_bool(4) == true );
+        REQUIRE( std::holds_alternative<std::nullptr_t>(rows[1].get_value(1)) );
+        REQUIRE( std::holds_alternative<std::nullptr_t>(rows[1].get_value(3)) );
+
+        // Unsupported column types fall back to text format
+        int count = 0;
+        stats = db->copy_to("SELECT int_val, 1.25::NUMERIC, text_val, blob_val FROM binding_test WHERE int_val >= 700 ORDER BY int_val",
+            [&](const sqlcpp::row_base& row) {
+                if(count++ == 0) {
+                    REQUIRE( row.get_value_int(0) == 700 );
+                    REQUIRE( row.get_value_string(1) == "1.25" );
+                    REQUIRE( row.get_value_string(2) == "tab\there" );
+                    REQUIRE( row.get_value_blob(3) == sqlcpp::blob{0x00, 0xFF} );
+                } else {
+                    REQUIRE( std::holds_alternative<std::nullptr_t>(row.get_value(2)) );
+                }
+            });
+        REQUIRE( !!stats );
+        REQUIRE( count == 2 );
+    }
+
     // Cleanup
     db->execute("DROP TABLE binding_test;");
 }
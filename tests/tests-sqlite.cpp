@@ -20,6 +20,7 @@
 #include "sqlcpp/sqlite.hpp"
 
 #include <iostream>
+#include <set>
 
 #include "sqlcpp/details.hpp"
 
@@ -222,12 +223,16 @@ TEST_CASE("Simple SQLite", "[sqlite]") {
         REQUIRE( !!stmt );
 
         std::vector<sqlcpp::details::generic_row> results;
+        std::set<const sqlcpp::row_base*> views;
 
         stmt->execute([&](const sqlcpp::row_base& row) {
             results.emplace_back(row);
+            views.insert(&row);
         });
 
         REQUIRE( results.size() == 3 );
+        // The same row view is reused for each row
+        REQUIRE( views.size() == 1 );
 
         {
             const auto& row = results[2];
@@ -278,6 +283,292 @@ TEST_CASE("Simple SQLite", "[sqlite]") {
         // TODO test boolean type
     }
 
+    SECTION("Columnar statement execution"){
+        // Blobs of the test table are mixed with text values, made uniform here
+        auto stmt = db->prepare("SELECT id, int64, double, text, CAST(blob AS BLOB) FROM test ORDER BY id");
+        REQUIRE( !!stmt );
+
+        auto rset = stmt->execute_columnar();
+        REQUIRE( !!rset );
+        REQUIRE( rset->has_row() );
+        REQUIRE( rset->row_count() == 3 );
+        REQUIRE( rset->column_count() == 5 );
+        REQUIRE( rset->column_name(3) == "text" );
+
+        REQUIRE( rset->storage_type(1) == sqlcpp::value_type::INT64 );
+        sqlcpp::span<const int64_t> ints = rset->int64_values(1);
+        REQUIRE( ints.size() == 3 );
+        int64_t sum = 0;
+        for(int64_t val : ints) {
+            sum += val;
+        }
+        REQUIRE( sum == 6 );
+
+        REQUIRE( rset->storage_type(2) == sqlcpp::value_type::DOUBLE );
+        REQUIRE( rset->double_values(2)[2] == 8.0 );
+        REQUIRE( rset->int_values(2).empty() );
+
+        REQUIRE( rset->storage_type(3) == sqlcpp::value_type::STRING );
+        REQUIRE( rset->string_value(3, 1) == "World" );
+
+        REQUIRE( rset->storage_type(4) == sqlcpp::value_type::BLOB );
+        REQUIRE( rset->is_valid(4, 0) );
+        REQUIRE( !rset->is_valid(4, 2) );
+        REQUIRE( rset->blob_value(4, 0).size() == 8 );
+
+        const auto& row = rset->get_row(1);
+        REQUIRE( row.get_value_int(0) == 2 );
+        REQUIRE( row.get_value_string(3) == "World" );
+        REQUIRE( row.get_value_blob(4) == sqlcpp::blob{'H', 'e', 'l', 'l', 'o'} );
+        REQUIRE( std::holds_alternative<std::nullptr_t>(rset->get_row(2).get_value(4)) );
+
+        int count = 0;
+        for (const sqlcpp::row& row : *rset) {
+            REQUIRE( row.get_value_int64(0) == ++count );
+        }
+        REQUIRE( count == 3 );
+
+        // Values of different types are stored as generic values
+        db->execute("CREATE TABLE mixed (val); INSERT INTO mixed VALUES (NULL), (1), ('one');");
+        auto mixed = db->prepare("SELECT val FROM mixed ORDER BY rowid")->execute_columnar();
+        REQUIRE( !!mixed );
+        REQUIRE( mixed->storage_type(0) == sqlcpp::value_type::UNSUPPORTED );
+        REQUIRE( !mixed->is_valid(0, 0) );
+        REQUIRE( std::holds_alternative<int64_t>(mixed->get_row(1).get_value(0)) );
+        REQUIRE( mixed->get_row(2).get_value_string(0) == "one" );
+
+        // Texts and blobs keep their own types
+        db->execute("DELETE FROM mixed; INSERT INTO mixed VALUES ('text'), (X'0102'), ('');");
+        mixed = db->prepare("SELECT val FROM mixed ORDER BY rowid")->execute_columnar();
+        REQUIRE( !!mixed );
+        REQUIRE( mixed->storage_type(0) == sqlcpp::value_type::UNSUPPORTED );
+        REQUIRE( std::holds_alternative<std::string>(mixed->get_row(0).get_value(0)) );
+        REQUIRE( mixed->get_row(1).get_value(0) == sqlcpp::value(sqlcpp::blob{0x01, 0x02}) );
+        REQUIRE( mixed->get_row(2).get_value(0) == sqlcpp::value(std::string()) );
+        db->execute("DROP TABLE mixed;");
+    }
+
+    SECTION("String and blob views"){
+        auto stmt = db->prepare("SELECT * FROM test ORDER BY id");
+        REQUIRE( !!stmt );
+
+        std::vector<std::string> texts;
+        std::vector<sqlcpp::blob> blobs;
+        stmt->execute([&](const sqlcpp::row_base& row) {
+            texts.emplace_back(row.get_value_string_view(3));
+            sqlcpp::blob_span data = row.get_value_blob_span(4);
+            blobs.emplace_back(data.begin(), data.end());
+            REQUIRE( row.get_value_string_view(1).empty() );
+        });
+        REQUIRE( texts == std::vector<std::string>{"Hello", "World", "!!!"} );
+        REQUIRE( blobs[0] == sqlcpp::blob{0x01, 0x02, 0x03, 0x04, 'a', 'b', 'c', 'd'} );
+        REQUIRE( blobs[1] == sqlcpp::blob{'H', 'e', 'l', 'l', 'o'} );
+        REQUIRE( blobs[2].empty() );
+
+        auto rset = stmt->execute();
+        REQUIRE( !!rset );
+        sqlcpp::details::generic_row copy(*rset->begin());
+        REQUIRE( copy.get_value_string_view(3) == "Hello" );
+        REQUIRE( copy.get_value_blob_span(4).size() == 8 );
+        REQUIRE( copy.get_value_blob_span(4)[4] == 'a' );
+        REQUIRE( copy.get_value_blob_span(0).empty() );
+    }
+
+    SECTION("Buffered views outlive the statement"){
+        std::shared_ptr<sqlcpp::buffered_resultset> rset;
+        {
+            auto stmt = db->prepare("SELECT * FROM test ORDER BY id");
+            REQUIRE( !!stmt );
+            rset = stmt->execute_buffered();
+        }
+        REQUIRE( !!rset );
+        REQUIRE( rset->row_count() == 3 );
+
+        const sqlcpp::row_base& first = rset->get_row(0);
+        REQUIRE( first.get_value_string_view(3) == "Hello" );
+        REQUIRE( first.get_value_blob_span(4).size() == 8 );
+        REQUIRE( first.get_value_blob_span(4)[0] == 0x01 );
+        REQUIRE( first.get_value_string_view(0).empty() );
+        REQUIRE( &rset->get_row(0) == &first );
+        REQUIRE( rset->get_row(1).get_value_string_view(3) == "World" );
+        REQUIRE( rset->get_row(2).get_value_blob_span(4).empty() );
+
+        std::vector<std::string> texts;
+        for (const sqlcpp::row& row : *rset) {
+            texts.emplace_back(row.get_value_string_view(3));
+        }
+        REQUIRE( texts == std::vector<std::string>{"Hello", "World", "!!!"} );
+
+        REQUIRE_THROWS_AS( rset->get_row(3), std::out_of_range );
+    }
+
+    SECTION("Typed execution"){
+        auto stmt = db->prepare("SELECT int64, text, double, blob FROM test ORDER BY id");
+        REQUIRE( !!stmt );
+
+        auto tuples = stmt->execute_as<std::tuple<int64_t, std::string, double, std::optional<sqlcpp::blob>>>();
+        REQUIRE( tuples.has_value() );
+        REQUIRE( tuples->size() == 3 );
+        REQUIRE( std::get<0>((*tuples)[0]) == 1 );
+        REQUIRE( std::get<1>((*tuples)[0]) == "Hello" );
+        REQUIRE( std::get<2>((*tuples)[0]) == 2.0 );
+        REQUIRE( std::get<3>((*tuples)[0]) == sqlcpp::blob{0x01, 0x02, 0x03, 0x04, 0x61, 0x62, 0x63, 0x64} );
+        REQUIRE( std::get<1>((*tuples)[2]) == "!!!" );
+        REQUIRE( !std::get<3>((*tuples)[2]).has_value() );
+
+        struct record {
+            int64_t id;
+            std::string_view text;
+            double value;
+            std::optional<sqlcpp::blob> data;
+        };
+        std::vector<std::string> texts;
+        int64_t sum = 0;
+        REQUIRE( stmt->execute_as<record>([&](const record& rec) {
+            texts.emplace_back(rec.text);
+            sum += rec.id;
+        }) );
+        REQUIRE( texts == std::vector<std::string>{"Hello", "World", "!!!"} );
+        REQUIRE( sum == 6 );
+
+        // Columns must match the fields
+        REQUIRE( !stmt->execute_as<std::tuple<int64_t, std::string>>().has_value() );
+        REQUIRE( !stmt->execute_as<std::tuple<std::string, std::string, double, sqlcpp::blob>>().has_value() );
+        REQUIRE( !stmt->execute_as<std::tuple<int, std::string, double, std::optional<sqlcpp::blob>>>().has_value() );
+        REQUIRE( !stmt->execute_as<std::tuple<bool, std::string, double, std::optional<sqlcpp::blob>>>().has_value() );
+        REQUIRE( !stmt->execute_as<std::tuple<int64_t, std::string>>([](const std::tuple<int64_t, std::string>&) {}) );
+
+        // No rows is not a failure
+        auto empty = db->prepare("SELECT int64, text FROM test WHERE id < 0")->execute_as<std::tuple<int64_t, std::string>>();
+        REQUIRE( empty.has_value() );
+        REQUIRE( empty->empty() );
+    }
+
+    SECTION("Batch fetch"){
+        auto stmt = db->prepare("SELECT int64, double, NULLIF(int64, 2) FROM test ORDER BY id");
+        REQUIRE( !!stmt );
+
+        int64_t ints[2];
+        double doubles[2];
+        double nullable[2];
+        uint8_t validity[1];
+        std::vector<sqlcpp::batch_column> columns = {
+            {0, sqlcpp::span<int64_t>(ints, 2)},
+            {1, sqlcpp::span<double>(doubles, 2)},
+            {2, sqlcpp::span<double>(nullable, 2), sqlcpp::span<uint8_t>(validity, 1)},
+        };
+
+        auto rset = stmt->execute();
+        REQUIRE( rset->fetch_batch(columns) == 2 );
+        REQUIRE( ints[0] == 1 );
+        REQUIRE( ints[1] == 2 );
+        REQUIRE( doubles[0] == 2.0 );
+        REQUIRE( doubles[1] == 4.0 );
+        REQUIRE( nullable[0] == 1.0 );
+        REQUIRE( (validity[0] & 0x03) == 0x01 );
+
+        REQUIRE( rset->fetch_batch(columns) == 1 );
+        REQUIRE( ints[0] == 3 );
+        REQUIRE( doubles[0] == 8.0 );
+        REQUIRE( (validity[0] & 0x01) == 0x01 );
+
+        REQUIRE( rset->fetch_batch(columns) == 0 );
+
+        // Buffered results fetch through their rows
+        auto buffered = stmt->execute_buffered();
+        REQUIRE( buffered->fetch_batch(columns) == 2 );
+        REQUIRE( ints[1] == 2 );
+        REQUIRE( (validity[0] & 0x02) == 0 );
+        REQUIRE( buffered->fetch_batch(columns) == 1 );
+        REQUIRE( buffered->fetch_batch(columns) == 0 );
+
+        // Generic implementation, for resultsets without fast path
+        auto generic = stmt->execute();
+        REQUIRE( generic->sqlcpp::cursor_resultset::fetch_batch(columns) == 2 );
+        REQUIRE( ints[0] == 1 );
+        REQUIRE( doubles[1] == 4.0 );
+        REQUIRE( (validity[0] & 0x03) == 0x01 );
+        REQUIRE( generic->sqlcpp::cursor_resultset::fetch_batch(columns) == 1 );
+        REQUIRE( ints[0] == 3 );
+        REQUIRE( generic->sqlcpp::cursor_resultset::fetch_batch(columns) == 0 );
+    }
+
+    SECTION("Observer"){
+        struct recorder : public sqlcpp::connection_observer {
+            std::vector<std::string> events;
+            unsigned long long rows = 0;
+            unsigned long long bytes = 0;
+
+            void on_prepare(const std::string& query, std::chrono::nanoseconds duration, bool cache_hit) override {
+                events.push_back((cache_hit ? "hit " : "prepare ") + query);
+            }
+            void on_execute(const std::string& query, std::chrono::nanoseconds duration) override {
+                events.push_back("execute " + query);
+            }
+            void on_fetch(const std::string& query, unsigned long long fetched_rows, unsigned long long fetched_bytes, std::chrono::nanoseconds duration) override {
+                events.push_back("fetch " + query);
+                rows += fetched_rows;
+                bytes += fetched_bytes;
+            }
+        };
+        auto observer = std::make_shared<recorder>();
+        db->observer(observer);
+        REQUIRE( db->observer() == observer );
+
+        const std::string query = "SELECT int64, text FROM test ORDER BY id";
+        auto stmt = db->prepare_cached(query);
+        REQUIRE( !!stmt );
+        REQUIRE( db->prepare_cached(query) == stmt );
+
+        // Cursor fetches are reported when the resultset is released
+        {
+            auto rset = stmt->execute();
+            size_t count = 0;
+            for (const sqlcpp::row& row : *rset) {
+                count += row.ok();
+            }
+            REQUIRE( count == 3 );
+            REQUIRE( observer->rows == 0 );
+        }
+        // 8 bytes per integer, plus "Hello", "World" and "!!!"
+        REQUIRE( observer->rows == 3 );
+        REQUIRE( observer->bytes == 3 * 8 + 13 );
+
+        stmt->execute([](const sqlcpp::row_base&) {});
+        stmt->execute_buffered();
+        REQUIRE( observer->rows == 9 );
+        REQUIRE( observer->bytes == 3 * (3 * 8 + 13) );
+
+        db->execute("UPDATE test SET int64 = int64");
+        REQUIRE( observer->events == std::vector<std::string>{
+            "prepare " + query, "hit " + query,
+            "execute " + query, "fetch " + query,
+            "execute " + query, "fetch " + query,
+            "execute " + query, "fetch " + query,
+            "execute UPDATE test SET int64 = int64"
+        } );
+
+        // Batch fetches count the non-NULL values only
+        {
+            std::vector<int64_t> ints(8);
+            std::vector<int64_t> nullables(8);
+            std::vector<sqlcpp::batch_column> columns = {
+                {0, sqlcpp::span<int64_t>(ints)},
+                {1, sqlcpp::span<int64_t>(nullables)},
+            };
+            auto rset = db->prepare("SELECT int64, NULLIF(int64, 2) FROM test ORDER BY id")->execute();
+            REQUIRE( rset->fetch_batch(columns) == 3 );
+        }
+        REQUIRE( observer->rows == 12 );
+        REQUIRE( observer->bytes == 3 * (3 * 8 + 13) + 5 * 8 );
+
+        // Statements prepared without observer are not observed, cached ones are released
+        db->observer(nullptr);
+        REQUIRE( db->statement_cache_size() == 0 );
+        db->prepare_cached(query)->execute_buffered();
+        REQUIRE( observer->events.size() == 12 );
+    }
+
     // Cleanup
     db->execute("DROP TABLE test;");
 }
@@ -384,6 +675,34 @@ TEST_CASE("SQLite Variable Binding", "[sqlite][binding]")
         REQUIRE( std::holds_alternative<std::nullptr_t>(row.get_value(3)) );
     }
 
+    SECTION("Bind by reference")
+    {
+        auto stmt = db->prepare("INSERT INTO binding_test(int_val, text_val, blob_val) VALUES(?, ?, ?)");
+        REQUIRE( !!stmt );
+
+        std::string text = "first";
+        sqlcpp::blob data = {1, 2, 3};
+        stmt->bind(0, (int64_t)1);
+        stmt->bind_ref(1, std::string_view(text));
+        stmt->bind_ref(2, sqlcpp::blob_span(data));
+        stmt->execute();
+
+        // Referenced values are read at execution
+        text = "other";
+        data[0] = 9;
+        stmt->bind(0, (int64_t)2);
+        stmt->execute();
+
+        auto select_stmt = db->prepare("SELECT text_val, blob_val FROM binding_test ORDER BY int_val");
+        auto rset = select_stmt->execute_buffered();
+        REQUIRE( !!rset );
+        REQUIRE( rset->row_count() == 2 );
+        REQUIRE( rset->get_row(0).get_value_string(0) == "first" );
+        REQUIRE( rset->get_row(0).get_value_blob(1) == sqlcpp::blob{1, 2, 3} );
+        REQUIRE( rset->get_row(1).get_value_string(0) == "other" );
+        REQUIRE( rset->get_row(1).get_value_blob(1) == sqlcpp::blob{9, 2, 3} );
+    }
+
     SECTION("Multiple executions with different bindings")
     {
         auto stmt = db->prepare("INSERT INTO binding_test(int_val, text_val) VALUES(?, ?)");
@@ -409,6 +728,134 @@ TEST_CASE("SQLite Variable Binding", "[sqlite][binding]")
         REQUIRE( row.get_value_int64(0) == 2 );
     }
 
+    SECTION("Reset and re-execution")
+    {
+        auto stmt = db->prepare("INSERT INTO binding_test(int_val, text_val) VALUES(?, ?)");
+        REQUIRE( !!stmt );
+        for (int64_t i = 1; i <= 20; ++i) {
+            stmt->bind(0, i);
+            stmt->bind(1, std::string("loop"));
+            stmt->execute();
+        }
+
+        // Bindings are cleared (NULL) by reset
+        stmt->reset();
+        stmt->bind(1, std::string("reset"));
+        stmt->execute();
+
+        auto select_stmt = db->prepare("SELECT int_val FROM binding_test WHERE text_val = ? ORDER BY int_val");
+        REQUIRE( !!select_stmt );
+        select_stmt->bind(0, std::string("loop"));
+        int64_t sum = 0;
+        select_stmt->execute([&](const sqlcpp::row_base& row) {
+            sum += row.get_value_int64(0);
+        });
+        REQUIRE( sum == 210 );
+
+        // Partially consumed results are dropped by a new execution
+        {
+            auto rset = select_stmt->execute();
+            REQUIRE( !!rset );
+            auto it = rset->begin();
+            REQUIRE( (*it).get_value_int64(0) == 1 );
+            ++it;
+            REQUIRE( (*it).get_value_int64(0) == 2 );
+        }
+        auto rset = select_stmt->execute();
+        REQUIRE( !!rset );
+        REQUIRE( (*rset->begin()).get_value_int64(0) == 1 );
+
+        select_stmt->reset();
+        select_stmt->bind(0, std::string("reset"));
+        auto buffered = select_stmt->execute_buffered();
+        REQUIRE( !!buffered );
+        REQUIRE( buffered->row_count() == 1 );
+        REQUIRE( std::holds_alternative<std::nullptr_t>(buffered->get_row(0).get_value(0)) );
+    }
+
+    SECTION("Array binding")
+    {
+        const size_t count = 1000;
+        std::vector<int64_t> ints(count);
+        std::vector<double> reals(count);
+        std::vector<std::string> texts(count);
+        std::vector<uint8_t> text_nulls(count, 0);
+        for (size_t i = 0; i < count; ++i) {
+            ints[i] = i + 1;
+            reals[i] = i * 0.5;
+            texts[i] = "row" + std::to_string(i);
+            text_nulls[i] = i % 10 == 0;
+        }
+
+        auto stmt = db->prepare("INSERT INTO binding_test(int_val, real_val, text_val) VALUES(?, ?, ?)");
+        REQUIRE( !!stmt );
+        stmt->bind_array(0, sqlcpp::span<const int64_t>(ints));
+        stmt->bind_array(1, sqlcpp::span<const double>(reals));
+        stmt->bind_array(2, sqlcpp::span<const std::string>(texts), text_nulls);
+        auto res = stmt->execute_array();
+        REQUIRE( !!res );
+        REQUIRE( res->affected_rows() == count );
+
+        auto select_stmt = db->prepare("SELECT COUNT(*), SUM(int_val), COUNT(text_val) FROM binding_test");
+        REQUIRE( !!select_stmt );
+        auto rset = select_stmt->execute_buffered();
+        REQUIRE( !!rset );
+        REQUIRE( rset->get_row(0).get_value_int64(0) == count );
+        REQUIRE( rset->get_row(0).get_value_int64(1) == count * (count + 1) / 2 );
+        REQUIRE( rset->get_row(0).get_value_int64(2) == count - count / 10 );
+
+        // Arrays must have the same size
+        std::vector<int64_t> shorter(count - 1);
+        stmt->bind_array(0, sqlcpp::span<const int64_t>(shorter));
+        REQUIRE( !stmt->execute_array() );
+
+        // Arrays are unbound by reset
+        stmt->reset();
+        REQUIRE( !stmt->execute_array() );
+    }
+
+    SECTION("Cached statements")
+    {
+        REQUIRE( db->statement_cache_capacity() == 64 );
+
+        auto stmt = db->prepare_cached("INSERT INTO binding_test(int_val, text_val) VALUES(?, ?)");
+        REQUIRE( !!stmt );
+        stmt->bind(0, static_cast<int64_t>(10));
+        stmt->bind(1, std::string("cached"));
+        stmt->execute();
+
+        auto again = db->prepare_cached("INSERT INTO binding_test(int_val, text_val) VALUES(?, ?)");
+        REQUIRE( again == stmt );
+        again->bind(0, static_cast<int64_t>(11));
+        again->bind(1, std::string("cached"));
+        again->execute();
+
+        auto select_stmt = db->prepare_cached("SELECT COUNT(*) FROM binding_test WHERE text_val = 'cached'");
+        REQUIRE( !!select_stmt );
+        REQUIRE( db->statement_cache_size() == 2 );
+        auto rset = select_stmt->execute();
+        REQUIRE( !!rset );
+        REQUIRE( (*rset->begin()).get_value_int64(0) == 2 );
+
+        // Least recently used statement is released first
+        db->statement_cache_capacity(1);
+        REQUIRE( db->statement_cache_size() == 1 );
+        REQUIRE( db->prepare_cached("SELECT COUNT(*) FROM binding_test WHERE text_val = 'cached'") == select_stmt );
+        REQUIRE( db->prepare_cached("INSERT INTO binding_test(int_val, text_val) VALUES(?, ?)") != stmt );
+
+        REQUIRE( !db->prepare_cached("SELECT * FROM no_such_table") );
+        REQUIRE( db->statement_cache_size() == 1 );
+
+        db->statement_cache_capacity(0);
+        REQUIRE( db->statement_cache_size() == 0 );
+        REQUIRE( db->prepare_cached("SELECT 1") != db->prepare_cached("SELECT 1") );
+
+        db->statement_cache_capacity(64);
+        db->prepare_cached("SELECT 1");
+        db->clear_statement_cache();
+        REQUIRE( db->statement_cache_size() == 0 );
+    }
+
     SECTION("Bind different integer types")
     {
         auto stmt = db->prepare("INSERT INTO binding_test(int_val) VALUES(?)");